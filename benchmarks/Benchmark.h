@@ -0,0 +1,144 @@
+#pragma once
+
+// Minimal benchmark harness shared by the HDF5mm benchmarks.
+//
+// Each measurement is written to stdout as a single-line JSON object (JSON
+// Lines), so that results of different runs can be compared with standard
+// tools (e.g. jq, pandas.read_json(lines=True)). Every record has the fields
+// "benchmark", "iterations", "mean_s" and "min_s" (seconds per iteration),
+// plus benchmark-specific parameters. If a benchmark transfers data, "bytes"
+// (per iteration) and "MiB_per_s" (based on the mean time) are included.
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+/// Benchmark parameters, written as additional JSON fields.
+/// Values are written verbatim, so strings must include their quotes (see
+/// str()).
+using Params = std::vector<std::pair<std::string, std::string>>;
+
+/// Quote string value for use in Params.
+inline std::string str(const std::string &s) { return '"' + s + '"'; }
+
+template <typename T>
+inline std::string num(T x) {
+  std::ostringstream ss;
+  ss << x;
+  return ss.str();
+}
+
+/// Command-line options common to all benchmarks.
+struct Options {
+  /// Minimum measurement time for each benchmark (--min-time).
+  double min_time = 0.2;
+
+  /// Minimum number of iterations for each benchmark (--min-iters).
+  int min_iters = 3;
+
+  /// Only run benchmarks whose name contains this string (--filter).
+  std::string filter;
+
+  Options(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      if (arg == "--min-time" && i + 1 < argc) {
+        min_time = std::atof(argv[++i]);
+      } else if (arg == "--min-iters" && i + 1 < argc) {
+        min_iters = std::atoi(argv[++i]);
+      } else if (arg == "--filter" && i + 1 < argc) {
+        filter = argv[++i];
+      } else {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--min-time SECONDS] [--min-iters N] [--filter NAME]\n";
+        std::exit(arg == "--help" ? 0 : 1);
+      }
+    }
+  }
+
+  bool selected(const std::string &name) const {
+    return filter.empty() || name.find(filter) != std::string::npos;
+  }
+};
+
+/// Timing of a benchmark.
+struct Timing {
+  int iterations = 0;
+  double mean = 0;  // seconds per iteration
+  double min = std::numeric_limits<double>::infinity();
+};
+
+/// Run `f` once as warm-up, then repeatedly until both the minimum time and
+/// the minimum number of iterations are reached.
+template <typename F>
+inline Timing measure(const Options &opt, F &&f) {
+  f();
+  Timing t;
+  double total = 0;
+  while (total < opt.min_time || t.iterations < opt.min_iters) {
+    auto start = Clock::now();
+    f();
+    double dt = std::chrono::duration<double>(Clock::now() - start).count();
+    total += dt;
+    t.min = std::min(t.min, dt);
+    ++t.iterations;
+  }
+  t.mean = total / t.iterations;
+  return t;
+}
+
+/// Write one result record.
+/// If `bytes` is non-zero, the throughput is also written.
+inline void report(const std::string &name, const Params &params,
+                   const Timing &t, size_t bytes = 0,
+                   std::ostream &os = std::cout) {
+  os << "{\"benchmark\": " << str(name);
+  for (auto &p : params) os << ", " << str(p.first) << ": " << p.second;
+  os << ", \"iterations\": " << t.iterations << ", \"mean_s\": " << t.mean
+     << ", \"min_s\": " << t.min;
+  if (bytes) {
+    os << ", \"bytes\": " << bytes
+       << ", \"MiB_per_s\": " << bytes / t.mean / (1 << 20);
+  }
+  os << "}" << std::endl;
+}
+
+/// Write record describing the environment (library version, ...).
+inline void report_environment(const Params &extra = Params(),
+                               std::ostream &os = std::cout) {
+  unsigned maj, min, rel;
+  H5get_libversion(&maj, &min, &rel);
+  os << "{\"benchmark\": \"environment\", \"hdf5_version\": "
+     << str(num(maj) + "." + num(min) + "." + num(rel));
+#ifdef NDEBUG
+  os << ", \"ndebug\": true";
+#else
+  os << ", \"ndebug\": false";
+#endif
+  for (auto &p : extra) os << ", " << str(p.first) << ": " << p.second;
+  os << "}" << std::endl;
+}
+
+/// Human-readable size (used as a parameter).
+inline std::string size_name(size_t bytes) {
+  if (bytes >= (1 << 20) && bytes % (1 << 20) == 0)
+    return num(bytes >> 20) + "MiB";
+  if (bytes >= (1 << 10) && bytes % (1 << 10) == 0)
+    return num(bytes >> 10) + "KiB";
+  return num(bytes) + "B";
+}
+
+}  // namespace bench
@@ -0,0 +1,154 @@
+// Parallel (MPI-IO) benchmarks of HDF5mm.
+//
+// Each process writes and reads a contiguous block of rows of a shared 2D
+// dataset, using either collective or independent transfers. Two scalings are
+// measured:
+//
+//  - weak: each process transfers a fixed amount of data;
+//  - strong: the total amount of data is fixed and divided among processes.
+//
+// Scaling curves are obtained by running the benchmark with different numbers
+// of processes (e.g. `mpirun -np 1 ...`, `mpirun -np 2 ...`, ...) and
+// collecting the results, which are written by rank 0 to stdout in JSON Lines
+// format (see Benchmark.h). Times are the maximum over processes.
+
+#include "Benchmark.h"
+#include "HDF5.h"
+
+#include <mpi.h>
+
+#include <cstdio>  // remove
+
+constexpr char FILENAME_MPI[] = "bench_parallel.h5";
+
+using bench::num;
+using bench::str;
+
+int myrank(MPI_Comm comm = MPI_COMM_WORLD) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  return rank;
+}
+
+int MPI_num_procs(MPI_Comm comm = MPI_COMM_WORLD) {
+  int size;
+  MPI_Comm_size(comm, &size);
+  return size;
+}
+
+// Same as bench::measure, but all processes run the same number of iterations
+// (as decided on rank 0), and each iteration takes the time of the slowest
+// process.
+template <typename F>
+bench::Timing measure_mpi(const bench::Options &opt, F &&f) {
+  f();
+  bench::Timing t;
+  double total = 0;
+  int more = 1;
+  while (more) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    auto start = bench::Clock::now();
+    f();
+    double dt =
+        std::chrono::duration<double>(bench::Clock::now() - start).count();
+    MPI_Allreduce(MPI_IN_PLACE, &dt, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    total += dt;
+    t.min = std::min(t.min, dt);
+    ++t.iterations;
+    more = total < opt.min_time || t.iterations < opt.min_iters;
+    MPI_Bcast(&more, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  }
+  t.mean = total / t.iterations;
+  return t;
+}
+
+// Write and read a (Nproc * nrows, ncols) dataset of doubles, where each
+// process accesses `nrows` rows.
+void bench_rows(const bench::Options &opt, const std::string &scaling,
+                hsize_t nrows, hsize_t ncols) {
+  using namespace HDF5;
+  const hsize_t Nproc = MPI_num_procs();
+  const hsize_t rank = myrank();
+  const bool root = rank == 0;
+  const char *layouts[] = {"contiguous", "chunked"};
+  const char *modes[] = {"collective", "independent"};
+
+  PropList::FileAcc fapl;
+  fapl.set_mpio(MPI_COMM_WORLD).set_alignment(1 << 16, 1 << 20);
+
+  default_init_vector<double> data(nrows * ncols);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = rank + 1e-6 * i;
+  default_init_vector<double> buf(data.size());
+  const size_t nbytes_total = Nproc * data.size() * sizeof(double);
+
+  for (const std::string layout : layouts) {
+    File F(FILENAME_MPI, "w", fapl);
+    PropList::DSetCreat dcpl;
+    if (layout == "chunked") dcpl.set_chunk({nrows, ncols});
+    DataSpace filespace({Nproc * nrows, ncols});
+    auto dset = F.create_dataset("rows", PredType::NATIVE_DOUBLE(), filespace,
+                                 dcpl);
+    DataSpace memspace({nrows, ncols});
+    DataSpace::Hyperslab<2> h;
+    h.start = {rank * nrows, 0};
+    h.count = {nrows, ncols};
+    filespace.select_hyperslab(h);
+
+    for (const std::string mode : modes) {
+      PropList::DSetXfer dxpl;
+      if (mode == "collective")
+        dxpl.set_mpio_collective();
+      else
+        dxpl.set_mpio_independent();
+      const bench::Params params = {
+          {"scaling", str(scaling)},
+          {"layout", str(layout)},
+          {"mode", str(mode)},
+          {"nprocs", num(Nproc)},
+          {"size_per_proc", str(bench::size_name(nbytes_total / Nproc))}};
+
+      if (opt.selected("mpi_write")) {
+        auto t = measure_mpi(opt, [&] {
+          dset.write(data.data(), PredType::NATIVE_DOUBLE(), memspace,
+                     filespace, dxpl);
+          F.flush(false);
+        });
+        if (root) bench::report("mpi_write", params, t, nbytes_total);
+      } else {
+        dset.write(data.data(), PredType::NATIVE_DOUBLE(), memspace, filespace,
+                   dxpl);
+      }
+
+      if (opt.selected("mpi_read")) {
+        auto t = measure_mpi(opt, [&] {
+          dset.read(buf.data(), PredType::NATIVE_DOUBLE(), memspace, filespace,
+                    dxpl);
+        });
+        if (root) bench::report("mpi_read", params, t, nbytes_total);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  MPI_Init(&argc, &argv);
+  {
+    bench::Options opt(argc, argv);
+    const hsize_t Nproc = MPI_num_procs();
+    constexpr hsize_t NCOLS = 1024;  // 8 KiB rows
+    if (myrank() == 0) bench::report_environment({{"nprocs", num(Nproc)}});
+
+    // Weak scaling: 4 and 64 MiB per process.
+    bench_rows(opt, "weak", 512, NCOLS);
+    bench_rows(opt, "weak", 8192, NCOLS);
+
+    // Strong scaling: 256 MiB in total.
+    const hsize_t total_rows = 32768;
+    if (total_rows % Nproc == 0)
+      bench_rows(opt, "strong", total_rows / Nproc, NCOLS);
+
+    if (myrank() == 0) std::remove(FILENAME_MPI);
+  }
+  MPI_Finalize();
+  return 0;
+}
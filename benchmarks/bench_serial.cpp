@@ -0,0 +1,241 @@
+// Serial benchmarks of HDF5mm hot paths.
+//
+// Results are written to stdout in JSON Lines format (see Benchmark.h).
+// Reads are measured with a warm operating system page cache, so that they
+// reflect the cost of the HDF5 library and of the wrapper rather than of the
+// storage device.
+
+#include "Benchmark.h"
+#include "HDF5.h"
+
+#include <cmath>
+#include <cstdio>  // remove
+
+constexpr char FILENAME[] = "bench_serial.h5";
+
+using bench::num;
+using bench::str;
+
+// Handle creation, copy and destruction.
+void bench_handles(const bench::Options &opt) {
+  using namespace HDF5;
+  constexpr int N = 1000;  // operations per iteration
+  File F(FILENAME, "r+");
+  auto dset = F.create_dataset("handles", PredType::NATIVE_INT(), {16});
+
+  if (opt.selected("handle_dataspace_create")) {
+    auto t = bench::measure(opt, [] {
+      for (int i = 0; i < N; ++i) DataSpace space({16, 16});
+    });
+    bench::report("handle_dataspace_create", {{"ops", num(N)}}, t);
+  }
+
+  if (opt.selected("handle_copy")) {
+    auto t = bench::measure(opt, [&] {
+      for (int i = 0; i < N; ++i) DataSet copy(dset);
+    });
+    bench::report("handle_copy", {{"ops", num(N)}}, t);
+  }
+
+  if (opt.selected("handle_move")) {
+    auto t = bench::measure(opt, [&] {
+      DataSet a(dset);
+      for (int i = 0; i < N; ++i) {
+        DataSet b(std::move(a));
+        a = std::move(b);
+      }
+    });
+    bench::report("handle_move", {{"ops", num(N)}}, t);
+  }
+
+  if (opt.selected("handle_open_dataset")) {
+    auto t = bench::measure(opt, [&] {
+      for (int i = 0; i < N; ++i) F.open_dataset("handles");
+    });
+    bench::report("handle_open_dataset", {{"ops", num(N)}}, t);
+  }
+
+  if (opt.selected("handle_get_dataspace")) {
+    auto t = bench::measure(opt, [&] {
+      for (int i = 0; i < N; ++i) dset.get_dataspace().size(0);
+    });
+    bench::report("handle_get_dataspace", {{"ops", num(N)}}, t);
+  }
+}
+
+// Small attribute write and read.
+void bench_attributes(const bench::Options &opt) {
+  using namespace HDF5;
+  constexpr int N = 100;  // operations per iteration
+  File F(FILENAME, "r+");
+  auto g = F.create_group("attributes");
+  g.write_attribute(1.0, "scalar");
+  g.write_attribute(std::vector<int>(16, 1), "vector");
+
+  if (opt.selected("attribute_write")) {
+    auto t = bench::measure(opt, [&] {
+      for (int i = 0; i < N; ++i) g.open_attribute("scalar").write(double(i));
+    });
+    bench::report("attribute_write", {{"type", str("double")}, {"ops", num(N)}},
+                  t);
+  }
+
+  if (opt.selected("attribute_read")) {
+    double x;
+    auto t = bench::measure(opt, [&] {
+      for (int i = 0; i < N; ++i) g.open_attribute("scalar").read(x);
+    });
+    bench::report("attribute_read", {{"type", str("double")}, {"ops", num(N)}},
+                  t);
+  }
+
+  if (opt.selected("attribute_read_vector")) {
+    std::vector<int> v;
+    auto t = bench::measure(opt, [&] {
+      for (int i = 0; i < N; ++i) g.open_attribute("vector").read(v);
+    });
+    bench::report("attribute_read_vector",
+                  {{"type", str("int[16]")}, {"ops", num(N)}}, t);
+  }
+}
+
+// Throughput of whole-dataset writes and reads for different layouts.
+void bench_layouts(const bench::Options &opt) {
+  using namespace HDF5;
+  const size_t sizes[] = {64 << 10, 1 << 20, 16 << 20, 64 << 20};
+  const char *layouts[] = {"contiguous", "chunked", "shuffle_deflate"};
+  constexpr hsize_t CHUNK = 1 << 16;  // elements (512 KiB of doubles)
+
+  for (size_t nbytes : sizes) {
+    const hsize_t N = nbytes / sizeof(double);
+    // Smooth data, which can be compressed to some extent.
+    default_init_vector<double> data(N);
+    for (hsize_t i = 0; i < N; ++i) data[i] = std::sin(1e-3 * i);
+    default_init_vector<double> buf;
+
+    for (const std::string layout : layouts) {
+      const std::string wname = "dataset_write", rname = "dataset_read";
+      if (!opt.selected(wname) && !opt.selected(rname)) continue;
+      const bench::Params params = {{"layout", str(layout)},
+                                    {"size", str(bench::size_name(nbytes))}};
+      File F(FILENAME, "r+");
+      PropList::DSetCreat dcpl;
+      if (layout != "contiguous") dcpl.set_chunk({std::min(N, CHUNK)});
+      if (layout == "shuffle_deflate") dcpl.set_shuffle().set_deflate(4);
+      auto dset = F.create_dataset("layout_" + layout + "_" + num(nbytes),
+                                   PredType::NATIVE_DOUBLE(), {N}, dcpl);
+
+      if (opt.selected(wname)) {
+        auto t = bench::measure(opt, [&] {
+          dset.write(data);
+          F.flush(false);
+        });
+        bench::report(wname, params, t, nbytes);
+      } else {
+        dset.write(data);
+      }
+
+      if (opt.selected(rname)) {
+        auto t = bench::measure(opt, [&] { dset.read(buf); });
+        bench::report(rname, params, t, nbytes);
+      }
+    }
+  }
+}
+
+// Hyperslab read patterns of a 2D dataset.
+void bench_hyperslabs(const bench::Options &opt) {
+  using namespace HDF5;
+  constexpr hsize_t N = 2048;   // dataset is N x N doubles (32 MiB)
+  constexpr hsize_t B = 64;     // width of row and column blocks
+  constexpr hsize_t S = 16;     // stride of strided selection
+  const char *layouts[] = {"contiguous", "chunked"};
+
+  default_init_vector<double> data(N * N);
+  for (hsize_t i = 0; i < N * N; ++i) data[i] = i;
+  default_init_vector<double> buf;
+
+  struct Pattern {
+    const char *name;
+    adims_t<2> start, stride, count;
+  };
+  const Pattern patterns[] = {
+      {"rows", {{N / 2, 0}}, {{1, 1}}, {{B, N}}},
+      {"columns", {{0, N / 2}}, {{1, 1}}, {{N, B}}},
+      {"strided", {{0, 0}}, {{S, S}}, {{N / S, N / S}}},
+      {"block", {{N / 4, N / 4}}, {{1, 1}}, {{N / 2, N / 2}}},
+  };
+
+  if (!opt.selected("hyperslab_read")) return;
+  for (const std::string layout : layouts) {
+    File F(FILENAME, "r+");
+    PropList::DSetCreat dcpl;
+    if (layout == "chunked") dcpl.set_chunk({256, 256});
+    auto dset = F.create_dataset("hyperslab_" + layout,
+                                 PredType::NATIVE_DOUBLE(), {N, N}, dcpl);
+    dset.write(data);
+
+    for (auto &p : patterns) {
+      DataSpace filespace = dset.get_dataspace();
+      filespace.select_hyperslab(H5S_SELECT_SET, p.count.data(), p.start.data(),
+                                 p.stride.data());
+      const hsize_t npoints = filespace.get_select_npoints();
+      DataSpace memspace({npoints});
+      buf.resize(npoints);
+      auto t = bench::measure(opt, [&] {
+        dset.read(buf.data(), PredType::NATIVE_DOUBLE(), memspace, filespace);
+      });
+      bench::report("hyperslab_read",
+                    {{"layout", str(layout)}, {"pattern", str(p.name)}}, t,
+                    npoints * sizeof(double));
+    }
+  }
+}
+
+// Scattered row reads with DataSet::gather, for isolated rows and for short
+// runs of consecutive rows.
+void bench_gather(const bench::Options &opt) {
+  using namespace HDF5;
+  constexpr hsize_t N = 1 << 20;  // dataset is N x 3 floats (12 MiB)
+  constexpr hsize_t M = 3;
+  const size_t counts[] = {1000, 100000, 1000000};
+  const hsize_t run_lengths[] = {1, 8};
+
+  if (!opt.selected("gather")) return;
+  default_init_vector<float> data(N * M);
+  for (hsize_t i = 0; i < N * M; ++i) data[i] = i;
+  File F(FILENAME, "r+");
+  auto dset = F.create_dataset("gather", PredType::NATIVE_FLOAT(), {N, M});
+  dset.write(data);
+
+  std::vector<hsize_t> indices;
+  default_init_vector<float> buf;
+  for (hsize_t len : run_lengths) {
+    for (size_t count : counts) {
+      // Runs start at pseudo-random positions, in unsorted order.
+      indices.clear();
+      for (size_t i = 0; indices.size() < count; ++i) {
+        const hsize_t start = (i * 7919 * len) % (N - len);
+        for (hsize_t j = 0; j < len && indices.size() < count; ++j)
+          indices.push_back(start + j);
+      }
+      auto t = bench::measure(opt, [&] { dset.gather(indices, buf); });
+      bench::report("gather",
+                    {{"indices", num(count)}, {"run_length", num(len)}}, t,
+                    count * M * sizeof(float));
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  bench::Options opt(argc, argv);
+  bench::report_environment();
+  { HDF5::File F(FILENAME, "w"); }
+  bench_handles(opt);
+  bench_attributes(opt);
+  bench_layouts(opt);
+  bench_hyperslabs(opt);
+  bench_gather(opt);
+  std::remove(FILENAME);
+  return 0;
+}
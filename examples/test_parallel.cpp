@@ -22,7 +22,12 @@ void test_write_mpi() {
   using namespace HDF5;
   PropList::FileAcc plist;
   const size_t Nproc = MPI_num_procs();
-  plist.set_mpio(MPI_COMM_WORLD);
+  MPIInfo info;
+  info.set_cb_buffer_size(4 << 20).set_romio_cb("automatic", "enable");
+  plist.set_mpio(MPI_COMM_WORLD, info)
+      .set_all_coll_metadata_ops()
+      .set_coll_metadata_write()
+      .set_alignment(1 << 16, 1 << 20);
   File ff(FILENAME_MPI, "w", plist);
   {
     // Write 2D array in parallel.
@@ -37,7 +42,7 @@ void test_write_mpi() {
         ff.create_dataset("rank_vector", PredType::NATIVE_INT(), filespace);
 
     PropList::DSetXfer dxpl;
-    dxpl.set_mpio_collective();
+    dxpl.set_mpio_collective().set_mpio_chunk_opt(H5FD_MPIO_CHUNK_ONE_IO);
     // dxpl.set_mpio_independent();
 
     DataSpace::Hyperslab<2> h;
@@ -86,6 +91,8 @@ void test_read_mpi() {
 
 int main(int argc, char **argv) {
   MPI_Init(&argc, &argv);
+  // Print summary of collective I/O modes when closing files.
+  HDF5::IOStats::enable_mpio();
   test_write_mpi();
   test_read_mpi();
   MPI_Finalize();
@@ -1,10 +1,32 @@
 #include "HDF5.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <type_traits>
+#include <utility>
 
 constexpr char FILENAME[] = "abc.h5";
 
+struct Vec3 {
+  float x, y, z;
+};
+HDF5MM_COMPOUND_TYPE(Vec3, x, y, z);
+
+struct Particle {
+  double pos[3];
+  Vec3 vel;
+  std::array<int, 2> cell;
+  float mass;
+  int64_t id;
+};
+HDF5MM_COMPOUND_TYPE(Particle, pos, vel, cell, mass, id);
+
 void test_fixed_string() {
   using namespace HDF5;
   File F(FILENAME, "r+");
@@ -50,6 +72,15 @@ void test_write() {
     g.write_dataset(3.2f, "three_two");
     g.write_dataset('a', "char_a");
   }
+  {
+    // Chunked dataset.
+    PropList::DSetCreat dcpl;
+    dcpl.set_chunk({4, 4});
+    std::vector<int> x(16 * 8);
+    for (size_t n = 0; n < x.size(); ++n) x[n] = n;
+    g.create_dataset("chunked", PredType::NATIVE_INT(), {16, 8}, dcpl)
+        .write(x);
+  }
   {
     std::string s = "aéíñsoj";
     auto dset = g.write_dataset(s, "mystr");
@@ -59,6 +90,821 @@ void test_write() {
   assert(F.get_obj_count() == 3);  // 1 file + 2 groups
 }
 
+void test_append() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  PropList::DSetCreat dcpl;
+  dcpl.set_chunk({4, 3});
+  DataSpace space({0, 3}, {DataSpace::UNLIMITED, 3});
+  auto dset = F.create_dataset("timeseries", PredType::NATIVE_DOUBLE(), space,
+                               dcpl);
+  assert(dset.get_dataspace().max_size()[0] == DataSpace::UNLIMITED);
+  {
+    // Append one record at a time, then several records at once.
+    double rec[3] = {1, 2, 3};
+    dset.append(rec).append(rec);
+    std::vector<double> recs(9, 4.2);
+    dset.append(recs);
+  }
+  assert((dset.get_dataspace().size() == dims_t{5, 3}));
+  dset.extend(2);
+  assert(dset.get_dataspace().size(0) == 7);
+  std::vector<double> x;
+  dset.read(x);
+  assert(x.size() == 21 && x[4] == 2 && x[14] == 4.2 && x[20] == 0);
+
+  // Appends through copies of the handle don't overwrite each other.
+  {
+    DataSpace s1({0}, {DataSpace::UNLIMITED});
+    PropList::DSetCreat p1;
+    p1.set_chunk({4});
+    auto d = F.create_dataset("records", PredType::NATIVE_INT(), s1, p1);
+    d.append(std::vector<int>{1, 2});
+    DataSet d2 = d;
+    d.append(std::vector<int>{3, 4});
+    d2.append(std::vector<int>{9, 9});
+    std::vector<int> v;
+    d.read(v);
+    assert((v == std::vector<int>{1, 2, 3, 4, 9, 9}));
+  }
+}
+
+void test_direct_chunk() {
+#if H5_VERSION_GE(1, 10, 2)
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  auto dset = F.open_dataset("mygroup/chunked");  // 16x8 ints, 4x4 chunks
+  std::vector<char> buf;
+  uint32_t mask;
+  dset.read_chunk({4, 4}, buf, &mask);
+  assert(buf.size() == 16 * sizeof(int) && mask == 0);
+  auto p = reinterpret_cast<int *>(buf.data());
+  assert(p[0] == 4 * 8 + 4 && p[5] == 5 * 8 + 5);
+  for (int n = 0; n < 16; ++n) p[n] = -n;
+  dset.write_chunk({4, 4}, buf);
+  std::vector<int> x;
+  dset.read(x);
+  assert(x[4 * 8 + 4] == 0 && x[5 * 8 + 5] == -5);
+#endif
+}
+
+void test_chunked_writer() {
+#if H5_VERSION_GE(1, 10, 2) && defined(HDF5MM_HAVE_ZLIB)
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  // Chunks don't divide the dataset dimensions.
+  PropList::DSetCreat dcpl;
+  dcpl.set_chunk({4, 3, 5}).set_shuffle().set_deflate(4);
+  auto dset = F.create_dataset("compressed", PredType::NATIVE_DOUBLE(),
+                               {10, 7, 6}, dcpl);
+  std::vector<double> x(10 * 7 * 6);
+  for (size_t n = 0; n < x.size(); ++n) x[n] = 0.5 * n;
+  ChunkedWriter(dset, ChunkedWriter::shuffle_deflate(4), 3)
+      .set_max_pending(2)
+      .write(x);
+  std::vector<double> y;
+  dset.read(y);
+  assert(x == y);
+#endif
+}
+
+void test_parallel_reader() {
+#if H5_VERSION_GE(1, 10, 2)
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  PropList::DSetCreat dcpl;
+  dcpl.set_chunk({4, 3, 5}).set_shuffle();
+#ifdef HDF5MM_HAVE_ZLIB
+  dcpl.set_deflate(4);
+#endif
+  auto dset = F.create_dataset("parallel_read", PredType::NATIVE_DOUBLE(),
+                               {10, 7, 12}, dcpl);
+  // Only write part of the dataset, so that some chunks are not allocated.
+  std::vector<double> x(10 * 7 * 12, 0.0);
+  {
+    std::vector<double> part(6 * 7 * 12);
+    for (size_t n = 0; n < part.size(); ++n) part[n] = 0.25 * n;
+    std::copy(part.begin(), part.end(), x.begin());
+    auto fspace = dset.get_dataspace();
+    dims_t count = {6, 7, 12};
+    fspace.select_hyperslab(H5S_SELECT_SET, count.data(), dims_t(3, 0).data());
+    dset.write(part, DataSpace(count), fspace);
+  }
+  ParallelReader reader(dset, 3);
+  assert(reader.decodes_chunks());
+  std::vector<double> y;
+  reader.read(y);
+  assert(x == y);
+
+  // Block not aligned to chunks.
+  dims_t start = {3, 1, 2}, count = {5, 5, 9};
+  std::vector<double> z(5 * 5 * 9);
+  reader.read(z.data(), start, count);
+  for (hsize_t i = 0; i < count[0]; ++i)
+    for (hsize_t j = 0; j < count[1]; ++j)
+      for (hsize_t k = 0; k < count[2]; ++k)
+        assert(z[(i * count[1] + j) * count[2] + k] ==
+               x[((start[0] + i) * 7 + start[1] + j) * 12 + start[2] + k]);
+
+  // Datatype conversion: read by HDF5.
+  std::vector<float> f;
+  reader.read(f);
+  for (size_t n = 0; n < x.size(); ++n) assert(f[n] == float(x[n]));
+
+  // Contiguous dataset.
+  std::vector<double> c;
+  ParallelReader(F.open_dataset("mygroup/dset2d"), 2).read(c);
+  assert(c.size() == 15 && c[14] == 3.2 * 14);
+#endif
+}
+
+void test_slab_iterator() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  PropList::DSetCreat dcpl;
+  dcpl.set_chunk({2, 3, 4, 5});
+  const dims_t dims = {3, 4, 8, 6};
+  auto dset = F.create_dataset("slabs4d", PredType::NATIVE_INT(), dims, dcpl);
+  std::vector<int> x(3 * 4 * 8 * 6);
+  for (size_t n = 0; n < x.size(); ++n) x[n] = int(n);
+  dset.write(x);
+
+  // Blocks default to the chunk dimensions.
+  SlabIterator<int, 4> it(dset);
+  assert(it.num_blocks() == 2 * 2 * 2 * 2);
+  assert(it.block() == (adims_t<4>{2, 3, 4, 5}));
+  std::vector<int> y(x.size(), -1);
+  size_t nblocks = 0;
+  while (it.next()) {
+    assert(it.index() == nblocks++);
+    auto &start = it.start(), &count = it.count();
+    size_t m = 0;
+    for (hsize_t i = start[0]; i < start[0] + count[0]; ++i)
+      for (hsize_t j = start[1]; j < start[1] + count[1]; ++j)
+        for (hsize_t k = start[2]; k < start[2] + count[2]; ++k)
+          for (hsize_t l = start[3]; l < start[3] + count[3]; ++l)
+            y[((i * dims[1] + j) * dims[2] + k) * dims[3] + l] = it.data()[m++];
+    assert(m == it.data().size());
+  }
+  assert(nblocks == it.num_blocks() && !it.next());
+  assert(x == y);
+
+  // Contiguous dataset: slabs along the first dimension.
+  SlabIterator<double, 2> rows(F.open_dataset("mygroup/dset2d"), {}, false);
+  assert(rows.num_blocks() == 3);
+  while (rows.next()) {
+    assert(rows.count() == (adims_t<2>{1, 5}));
+    assert(rows.data()[0] == 3.2 * 5 * rows.start()[0]);
+  }
+}
+
+void test_auto_chunk() {
+  using namespace HDF5;
+  using Hint = PropList::DSetCreat::AccessHint;
+  auto length = [](const dims_t &c) {
+    hsize_t N = 1;
+    for (auto n : c) N *= n;
+    return N;
+  };
+  {
+    auto c = PropList::DSetCreat::guess_chunk({1000, 1000, 1000}, 8);
+    assert(length(c) * 8 <= (1 << 20) && length(c) * 8 > (1 << 18));
+    assert(*std::max_element(c.begin(), c.end()) <=
+           2 * *std::min_element(c.begin(), c.end()));
+  }
+  // Small datasets fit in a single chunk.
+  assert(PropList::DSetCreat::guess_chunk({10, 20}, 4) == (dims_t{10, 20}));
+  // Plane reads.
+  assert(PropList::DSetCreat::guess_chunk({64, 512, 512}, 4, Hint::planes(0)) ==
+         (dims_t{1, 512, 512}));
+  assert(PropList::DSetCreat::guess_chunk({64, 512, 512}, 4,
+                                         Hint::planes(2))[2] == 1);
+  // Appending records of 100 elements.
+  assert(PropList::DSetCreat::guess_chunk({0, 100}, 8, Hint::append()) ==
+         (dims_t{1310, 100}));
+  // Chunks don't exceed fixed maximum dimensions.
+  assert(PropList::DSetCreat::guess_chunk({0, 100}, 8, Hint::append(),
+                                         {DataSpace::UNLIMITED, 100}) ==
+         (dims_t{1310, 100}));
+  assert(PropList::DSetCreat::guess_chunk({10, 100}, 8, Hint::append(),
+                                         {10, 100}) == (dims_t{10, 100}));
+  // A smaller chunk cache limits the chunk size.
+  assert(length(PropList::DSetCreat::guess_chunk(
+             {1000, 1000}, 8, Hint::balanced().set_cache_size(1 << 16))) *
+             8 <= (1 << 16));
+  {
+    // Chunks are aligned to the blocks of a 2x3 process grid.
+    auto c = PropList::DSetCreat::guess_chunk(
+        {1000, 900}, 8, Hint::balanced().set_decomposition({2, 3}));
+    assert(500 % c[0] == 0 && 300 % c[1] == 0 && length(c) * 8 <= (1 << 20));
+  }
+
+  File F(FILENAME, "r+");
+  PropList::DSetCreat dcpl;
+  dcpl.set_shuffle();
+  auto dset = F.create_dataset("auto_chunked", PredType::NATIVE_FLOAT(),
+                               {64, 512, 512}, Hint::planes(0), dcpl);
+  assert(dset.get_create_plist().get_chunk() == (dims_t{1, 512, 512}));
+  // The chunk cache size is taken from the access property list.
+  PropList::DSetAcc dapl;
+  dapl.set_chunk_cache(521, 1 << 16);
+  dset = F.create_dataset("auto_chunked_small", PredType::NATIVE_FLOAT(),
+                          {64, 512, 512}, Hint::planes(0),
+                          PropList::DSetCreat(), dapl);
+  assert(length(dset.get_create_plist().get_chunk()) * 4 <= (1 << 16));
+  // Appending hint with a fixed-size dataspace.
+  dset = F.create_dataset("auto_chunked_fixed", PredType::NATIVE_DOUBLE(),
+                          {10, 100}, Hint::append());
+  assert(dset.get_create_plist().get_chunk() == (dims_t{10, 100}));
+}
+
+void test_filters() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  std::vector<int> x(40 * 30);
+  for (size_t n = 0; n < x.size(); ++n) x[n] = int(n % 97);
+  auto check = [&](const std::string &name, const PropList::DSetCreat &dcpl) {
+    auto dset = F.create_dataset(name, PredType::NATIVE_INT(), {40, 30}, dcpl);
+    dset.write(x);
+    std::vector<int> y;
+    dset.read(y);
+    assert(x == y);
+  };
+  {
+    // Generic filter interface (deflate with level 4).
+    PropList::DSetCreat dcpl;
+    dcpl.set_chunk({10, 30}).set_filter(H5Z_FILTER_DEFLATE, H5Z_FLAG_MANDATORY,
+                                        {4});
+    check("filter_deflate", dcpl);
+  }
+  {
+    // Lossless scale-offset compression of integers.
+    PropList::DSetCreat dcpl;
+    dcpl.set_chunk({10, 30}).set_scaleoffset(H5Z_SO_INT,
+                                             H5Z_SO_INT_MINBITS_DEFAULT);
+    check("filter_scaleoffset", dcpl);
+  }
+  {
+    // The Zstandard plugin may not be installed.
+    PropList::DSetCreat dcpl;
+    dcpl.set_chunk({10, 30});
+    if (PropList::DSetCreat::filter_available(
+            PropList::DSetCreat::FILTER_ZSTD)) {
+      check("filter_zstd", dcpl.set_zstd(5));
+    } else {
+      bool thrown = false;
+      try {
+        dcpl.set_zstd(5);
+      } catch (Exception &e) {
+        thrown = std::string(e.what()).find("Zstandard") != std::string::npos;
+      }
+      assert(thrown);
+    }
+  }
+}
+
+void test_drivers() {
+  using namespace HDF5;
+  std::vector<double> x(100000);
+  for (size_t n = 0; n < x.size(); ++n) x[n] = 0.5 * n;
+  std::vector<char> image;
+  {
+    // In-memory file, never written to disk.
+    PropList::FileAcc fapl;
+    fapl.set_fapl_core(1 << 16, false);
+    assert(fapl.get_driver() == H5FD_CORE);
+    File F("in_memory.h5", "w", fapl);
+    F.write_dataset(x, "x");
+    F.flush();
+    image = F.get_image();
+  }
+  assert(!std::ifstream("in_memory.h5").good());
+  {
+    // Open from image and modify it in memory.
+    auto F = File::from_image(image, H5F_ACC_RDWR);
+    assert(F.read_dataset<std::vector<double>>("x") == x);
+    F.write_dataset(3.5, "y");
+    F.flush();
+    auto G = File::from_image(F.get_image());
+    assert(G.read_dataset<double>("y") == 3.5);
+  }
+  {
+    // Members of 256 KiB.
+    PropList::FileAcc fapl;
+    fapl.set_fapl_family(1 << 18);
+    File("family-%02d.h5", "w", fapl).write_dataset(x, "x");
+    std::ifstream first("family-00.h5"), last("family-03.h5");
+    assert(first.good() && last.good());
+    File F("family-%02d.h5", "r", fapl);
+    assert(F.read_dataset<std::vector<double>>("x") == x);
+  }
+  {
+    // Metadata and raw data in separate files.
+    PropList::FileAcc fapl;
+    fapl.set_fapl_split(".meta", PropList::FileAcc::DEFAULT(), ".raw");
+    File("split", "w", fapl).write_dataset(x, "x");
+    std::ifstream meta("split.meta"), raw("split.raw", std::ios::ate);
+    assert(meta.good() && size_t(raw.tellg()) >= x.size() * sizeof(double));
+    File F("split", "r", fapl);
+    assert(F.read_dataset<std::vector<double>>("x") == x);
+  }
+}
+
+void test_page_buffer() {
+#if H5_VERSION_GE(1, 10, 1)
+  using namespace HDF5;
+  PropList::FileCreat fcpl;
+  fcpl.set_file_space_strategy(H5F_FSPACE_STRATEGY_PAGE)
+      .set_file_space_page_size(16 << 10);
+  PropList::FileAcc fapl;
+  fapl.set_page_buffer_size(256 << 10);
+  {
+    File F("paged.h5", "w", fapl, fcpl);
+    auto fcpl_file = F.get_create_plist();
+    assert(fcpl_file.get_file_space_strategy() == H5F_FSPACE_STRATEGY_PAGE);
+    assert(fcpl_file.get_file_space_page_size() == 16 << 10);
+    for (int i = 0; i < 50; ++i) {
+      auto g = F.create_group("g" + std::to_string(i));
+      g.write_dataset(i, "value");
+      g.create_attribute("name", PredType::NATIVE_INT()).write(i);
+    }
+  }
+  File F("paged.h5", "r", fapl);
+  for (int i = 0; i < 50; i += 7) {
+    auto g = F.open_group("g" + std::to_string(i));
+    assert(g.read_dataset<int>("value") == i);
+    int j;
+    g.open_attribute("name").read(j);
+    assert(j == i);
+  }
+#endif
+}
+
+void test_gather() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  std::vector<int> x(1000);
+  for (size_t n = 0; n < x.size(); ++n) x[n] = 3 * int(n);
+  auto dset = F.write_dataset(x, "gather1d");
+  std::vector<int> y;
+
+  // Sorted isolated points (point selection).
+  std::vector<hsize_t> points = {1, 17, 400, 999};
+  dset.gather(points, y);
+  assert(y == (std::vector<int>{3, 51, 1200, 2997}));
+
+  // Unsorted, repeated indices forming a few runs (hyperslab selection).
+  std::vector<hsize_t> runs = {12, 10, 11, 500, 501, 11, 502, 0};
+  dset.gather(runs, y);
+  assert(y.size() == runs.size());
+  for (size_t i = 0; i < runs.size(); ++i) assert(y[i] == 3 * int(runs[i]));
+
+  // Two long runs.
+  std::vector<hsize_t> blocks;
+  for (hsize_t i = 0; i < 100; ++i) blocks.push_back(i);
+  for (hsize_t i = 600; i < 700; ++i) blocks.push_back(i);
+  dset.gather(blocks, y);
+  assert(y.size() == blocks.size() && y[99] == 297 && y[100] == 1800);
+
+  dset.gather({}, y);
+  assert(y.empty());
+
+  // Rows of a 2D dataset.
+  auto dset2d = F.open_dataset("mygroup/dset2d");
+  std::vector<double> rows;
+  dset2d.gather({2, 0}, rows);
+  assert(rows.size() == 10 && rows[0] == 3.2 * 10 && rows[5] == 0.0);
+
+  // Point selection from a contiguous coordinate buffer.
+  auto space = dset2d.get_dataspace();
+  space.select_elements(std::vector<adims_t<2>>{{{1, 4}}, {{0, 1}}});
+  std::vector<double> z(2);
+  dset2d.read(z.data(), DataSpace({2}), space);
+  assert(z[0] == 3.2 * 9 && z[1] == 3.2);
+
+  // Many scattered rows, read in several batches of runs, which must not take
+  // time quadratic in their number.
+  constexpr hsize_t nrows = 400000, ncols = 3, nidx = 200000;
+  std::vector<float> table(nrows * ncols);
+  for (size_t n = 0; n < table.size(); ++n) table[n] = float(n);
+  auto big = F.create_dataset("gather_big", PredType::NATIVE_FLOAT(),
+                              {nrows, ncols});
+  big.write(table);
+  std::vector<hsize_t> scattered(nidx);
+  for (hsize_t i = 0; i < nidx; ++i) scattered[i] = (i * 7919) % nrows;
+  std::vector<float> picked;
+  auto t0 = std::chrono::steady_clock::now();
+  big.gather(scattered, picked);
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+  assert(picked.size() == nidx * ncols);
+  for (hsize_t i = 0; i < nidx; i += 997)
+    for (hsize_t j = 0; j < ncols; ++j)
+      assert(picked[i * ncols + j] == float(scattered[i] * ncols + j));
+  assert(dt.count() < 10);
+}
+
+void test_map() {
+  using namespace HDF5;
+  File F(FILENAME, "r");
+  {
+    // Contiguous dataset with native datatype: mapped.
+    auto view = F.open_dataset("mygroup/dset2d").map<double>();
+    assert(view.size() == 15 && view.dims() == (dims_t{3, 5}));
+#ifdef HDF5MM_HAVE_MMAP
+    assert(view.is_mapped());
+#endif
+    assert(view[14] == 3.2 * 14);
+  }
+  {
+    // Datatype conversion is needed: data is read into a buffer.
+    auto view = F.open_dataset("mygroup/dset2d").map<float>();
+    assert(!view.is_mapped() && view[2] == 6.4f);
+    // Chunked dataset.
+    auto chunked = F.open_dataset("mygroup/chunked").map<int>();
+    assert(!chunked.is_mapped() && chunked.size() == 16 * 8);
+  }
+}
+
+void test_write_async() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  auto dset = F.create_dataset("async", PredType::NATIVE_INT(), {4, 100});
+  std::vector<std::future<void>> writes;
+  DataSpace memspace({1, 100});
+  DataSpace filespace = dset.get_dataspace();
+  for (hsize_t i = 0; i < 4; ++i) {
+    // The selection is modified while previous writes may be in progress.
+    DataSpace::Hyperslab<2> h;
+    h.start = {i, 0};
+    h.count = {1, 100};
+    filespace.select_hyperslab(h);
+    writes.push_back(dset.write_async(std::vector<int>(100, int(i)), memspace,
+                                      filespace));
+  }
+  for (auto &w : writes) w.get();
+  std::vector<int> x;
+  dset.read(x);
+  assert(x[0] == 0 && x[150] == 1 && x[399] == 3);
+
+  // A dropped future waits for the write to complete.
+  dset.write_async(std::vector<int>(400, 7));
+  dset.read(x);
+  assert(x[0] == 7 && x[399] == 7);
+}
+
+void test_static_dataspace() {
+  using namespace HDF5;
+  File F(FILENAME, "r");
+  auto dset = F.open_dataset("mygroup/dset2d");  // 3x5 doubles
+  StaticDataSpace<2> filespace(dset.get_dataspace());
+  static_assert(StaticDataSpace<2>::ndims() == 2, "");
+  adims_t<2> dims = filespace.size();
+  assert(dims[0] == 3 && dims[1] == 5 && filespace[1] == 5);
+  assert(filespace.linear_index({2, 1}) == 11);
+
+  // Read the 2x2 block starting at (1, 2).
+  StaticDataSpace<2> memspace({2, 2});
+  filespace.select_block({1, 2}, {2, 2});
+  std::vector<double> x;
+  dset.read(x, memspace, filespace);
+  assert(x.size() == 4 && x[0] == 3.2 * 7 && x[3] == 3.2 * 13);
+
+  bool thrown = false;
+  try {
+    StaticDataSpace<3> s3(dset.get_dataspace());
+  } catch (Exception &) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+void test_multi_io() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  auto g = F.create_group("multi");
+  std::vector<double> u(10, 1.5);
+  std::vector<int> v(6, 42);
+  auto du = g.create_dataset("u", PredType::NATIVE_DOUBLE(), {10});
+  auto dv = g.create_dataset("v", PredType::NATIVE_INT(), {2, 3});
+  g.write_many({{du, u}, {dv, v.data()}});
+
+  std::vector<double> u2;
+  std::vector<int> v2;
+  DataSpace memspace({2});
+  DataSpace filespace = du.get_dataspace();
+  hsize_t start = 8, count = 2;
+  filespace.select_hyperslab(H5S_SELECT_SET, &count, &start);
+  F.read_many({{du, u2, memspace, filespace}, {dv, v2}});
+  assert(u2.size() == 2 && u2[1] == 1.5);
+  assert(v2 == v);
+}
+
+void test_io_stats() {
+  using namespace HDF5;
+  IOStats::enable_timing();
+  IOStats::set_output(nullptr);
+  File F(FILENAME, "r+");
+  std::vector<int> v(20, 3), w;
+  auto dset = F.create_dataset("stats", PredType::NATIVE_INT(), {4, 5});
+  dset.write(v).write(v);
+  DataSpace memspace({3});
+  DataSpace filespace = dset.get_dataspace();
+  hsize_t start[] = {1, 2}, count[] = {1, 3};
+  filespace.select_hyperslab(H5S_SELECT_SET, count, start);
+  std::vector<int> u(3);
+  dset.read(u.data(), PredType::NATIVE_INT(), memspace, filespace);
+  dset.write_attribute(1.5, "scale");
+
+  auto stats = F.io_stats();
+  auto &r = stats.at("/stats");
+  assert(r.write.ncalls == 2 && r.write.bytes == 2 * 20 * sizeof(int));
+  assert(r.read.ncalls == 1 && r.read.bytes == 3 * sizeof(int));
+  assert((r.read.last_shape == dims_t{1, 3}));
+  assert(stats.at("/stats@scale").write.bytes == sizeof(double));
+  IOStats::enable_timing(false);
+  dset.read(w);
+  assert(F.io_stats().at("/stats").read.ncalls == 1);
+
+  // The summary is printed and discarded when the file is closed.
+  std::ostringstream summary;
+  IOStats::set_output(&summary);
+  IOStats::enable_timing();
+  const std::string name = F.filename();
+  dset.close();
+  F.close();
+  IOStats::enable_timing(false);
+  IOStats::set_output(nullptr);
+  assert(summary.str().find("/stats@scale") != std::string::npos);
+  assert(IOStats::get(name).empty());
+}
+
+void test_handle_cache() {
+  using namespace HDF5;
+  File F(FILENAME, "r");
+  F.enable_handle_cache(2);
+  auto a = F.open_dataset("mygroup/chunked");
+  auto b = F.open_dataset("/mygroup/chunked");
+  assert(a.get_id() == b.get_id());
+  auto g = F.open_group("mygroup");
+  assert(F.open_group("mygroup").get_id() == g.get_id());
+  File F2 = F;  // copies share the cache
+  F2.open_dataset("stats");
+  F2.open_dataset("async");  // evicts "mygroup/chunked"
+  auto &cache = F.handle_cache()->datasets;
+  assert(cache.size() == 2 && cache.hits() == 1 && cache.misses() == 3);
+  assert(F.open_dataset("mygroup/chunked").get_id() != a.get_id());
+  assert(a.is_valid());  // evicted handles are still usable
+
+  // Access property lists with default values use the cache.
+  PropList::DSetAcc dapl;
+  assert(F.open_dataset("stats", dapl).get_id() ==
+         F.open_dataset("stats").get_id());
+  dapl.set_chunk_cache(11, 1 << 16);
+  assert(F.open_dataset("stats", dapl).get_id() !=
+         F.open_dataset("stats").get_id());
+
+  // Closing a copy keeps the cached handles, which are released when the
+  // last copy is closed.
+  auto by_value = [](File copy) { return copy.is_valid(); };
+  assert(by_value(F));
+  F2.close();
+  assert(cache.size() == 2 && F.handle_cache()->groups.size() == 1);
+  hid_t cached = F.open_dataset("async").get_id();
+  F.close();
+  assert(H5Iis_valid(cached) <= 0);
+}
+
+void test_create_groups() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  auto g = F.create_groups("deep/a/b/c");
+  assert(g.name() == "/deep/a/b/c" && F.is_group("deep/a/b"));
+  assert(F.create_groups("deep/a/b").name() == "/deep/a/b");  // existing
+  F.create_group("deep/x/y", PropList::LinkCreat::CREATE_PARENTS());
+  auto dset = F.create_dataset("deep/z/w/data", PredType::NATIVE_INT(), {3},
+                               PropList::DSetCreat::DEFAULT(),
+                               PropList::DSetAcc::DEFAULT(),
+                               PropList::LinkCreat::CREATE_PARENTS());
+  assert(F.is_group("deep/z/w") && F.exists("deep/z/w/data"));
+}
+
+void test_compound() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  std::vector<Particle> p(10);
+  for (size_t i = 0; i < p.size(); ++i) {
+    p[i].pos[0] = p[i].pos[1] = p[i].pos[2] = 0.5 * i;
+    p[i].vel = {1.f, 2.f, float(i)};
+    p[i].cell = {{int(i), -int(i)}};
+    p[i].mass = 2.f;
+    p[i].id = 1000 + i;
+  }
+  static_assert(std::is_base_of<PredType, CompoundType<Particle>>::value, "");
+  auto &type = PredType::get<Particle>();
+  assert(&type == &CompoundType<Particle>::instance());  // cached
+  assert(type.get_size() == sizeof(Particle));
+  assert(H5Tget_nmembers(type.get_id()) == 5);
+  F.write_dataset(p, "particles");
+
+  auto q = F.read_dataset<std::vector<Particle>>("particles");
+  assert(q.size() == p.size());
+  assert(q[3].pos[2] == 1.5 && q[3].vel.z == 3.f && q[3].cell[1] == -3);
+  assert(q[9].id == 1009 && q[9].mass == 2.f);
+
+  // Partial reads of a subset of members.
+  auto dset = F.open_dataset("particles");
+  std::vector<Particle> r(p.size());
+  for (auto &x : r) x.id = -1;
+  dset.read_fields({"mass", "vel"}, r);
+  assert(r[4].mass == 2.f && r[4].vel.z == 4.f && r[4].id == -1);
+  std::vector<int64_t> ids;
+  dset.read_field("id", ids);
+  assert(ids.size() == p.size() && ids[7] == 1007);
+  std::vector<double> masses;  // converted from float
+  dset.read_field("mass", masses);
+  assert(masses[0] == 2.0);
+}
+
+void test_strings() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  std::vector<std::string> labels = {"alpha", "", "γάμμα", "delta-delta"};
+  F.write_dataset(labels, "labels");  // variable-length strings
+  std::vector<std::string> v;
+  F.open_dataset("labels").read(v);
+  assert(v == labels);
+
+  // Read variable-length strings into contiguous buffer.
+  FixedStrings packed;
+  F.open_dataset("labels").read(packed);
+  assert(packed.size() == 4 && packed.width() == labels[3].size());
+  assert(packed.str(2) == labels[2] && packed.length(1) == 0);
+
+  // Fixed-length strings dataset.
+  auto dset = F.create_dataset("labels_fixed", packed.datatype(), {4});
+  dset.write(labels);
+  FixedStrings fixed;
+  dset.read(fixed);
+  assert(fixed.width() == packed.width() && fixed.str(3) == labels[3]);
+  dset.read(v);
+  assert(v == labels);
+  dset.write(FixedStrings({"a", "bb", "ccc", "dddd"}));
+  assert(F.read_dataset<std::vector<std::string>>("labels_fixed")[2] == "ccc");
+  {
+    // Vector with a different allocator.
+    default_init_vector<std::string> w(labels.rbegin(), labels.rend());
+    dset.write(w);
+    dset.read(v);
+    assert(v[0] == labels[3] && v[3] == labels[0]);
+  }
+
+  F.write_attribute(labels, "labels");
+  v.clear();
+  F.open_attribute("labels").read(v);
+  assert(v == labels);
+}
+
+void test_attributes() {
+  using namespace HDF5;
+  File F(FILENAME, "r+");
+  auto g = F.create_group("attrs");
+  g.write_attribute(1, "replaced");
+  g.write_attributes({{"count", 42},
+                      {"scale", 0.5},
+                      {"unit", "cm"},
+                      {"replaced", std::vector<double>{1.0, 2.0}},
+                      {"tags", std::vector<std::string>{"a", "bc"}},
+                      {"dims", std::vector<int>{3, 4, 5}}});
+  assert((g.attribute_names() ==
+          std::vector<std::string>{"count", "dims", "replaced", "scale",
+                                   "tags", "unit"}));
+  auto attrs = g.read_all_attributes();
+  assert(attrs.size() == 6);
+  assert(attrs["count"].is_scalar() && attrs["count"].as_int() == 42);
+  assert(attrs["scale"].as_double() == 0.5 &&
+         attrs["unit"].as_string() == "cm");
+  assert(!attrs["replaced"].is_scalar() && attrs["replaced"].doubles()[1] == 2);
+  assert(attrs["tags"].strings()[1] == "bc" && attrs["dims"].size() == 3);
+  assert(attrs["count"] == AttributeValue(42));
+
+  // Attributes written by other means.
+  auto more = F.open_dataset("stats").read_attributes({"scale"});
+  assert(more["scale"].as_double() == 1.5);
+}
+
+void test_index() {
+  using namespace HDF5;
+  File F(FILENAME, "r");
+  auto index = F.index();
+  assert(index.size() > 10);
+  auto e = index.find("/mygroup/chunked");
+  assert(e && e->is_dataset() && e->is_chunked());
+  assert(e->type_class == H5T_INTEGER && e->type_size == sizeof(int));
+  assert((index.dims(*e) == dims_t{16, 8}));
+  assert((index.chunk_dims(*e) == dims_t{4, 4}));
+  assert(index.find("/mygroup")->is_group());
+  assert(index.find("/nonexistent") == nullptr);
+  assert(std::is_sorted(index.begin(), index.end(),
+                        [](const ObjectIndex::Entry &a,
+                           const ObjectIndex::Entry &b) {
+                          return a.path < b.path;
+                        }));
+  for (auto p : index.datasets(2, H5T_FLOAT))
+    assert(p->ndims == 2 && p->type_class == H5T_FLOAT);
+  assert(!index.datasets(2, H5T_FLOAT).empty());  // mygroup/dset2d
+
+  // Index of a subgroup.
+  auto sub = F.open_group("deep").index();
+  assert(sub.find("/deep/z/w/data") && !sub.find("/mygroup"));
+}
+
+void test_persistent_index() {
+  using namespace HDF5;
+  {
+    File F(FILENAME, "r+");
+    F.use_persistent_index();  // built by traversal, saved on close
+    assert(F.has_persistent_index() && F.index().find("/mygroup/chunked"));
+  }
+  {
+    File F(FILENAME, "r");
+    assert(F.exists(ObjectIndex::persistent_path()));
+    auto traversed = F.index();
+    assert(!traversed.find(ObjectIndex::persistent_path()));
+    F.use_persistent_index();  // loaded from the file
+    auto loaded = F.index();
+    assert(loaded.size() == traversed.size());
+    for (size_t i = 0; i < loaded.size(); ++i) {
+      assert(loaded[i].path == traversed[i].path);
+      assert(loaded[i].layout == traversed[i].layout);
+      assert(loaded.dims(loaded[i]) == traversed.dims(traversed[i]));
+      assert(loaded.chunk_dims(loaded[i]) ==
+             traversed.chunk_dims(traversed[i]));
+    }
+    auto dset = F.open_dataset("mygroup/chunked");  // opened by address
+    assert(dset.name() == "/mygroup/chunked");
+    std::vector<int> v;
+    dset.read(v);
+    assert(v.size() == 16 * 8);
+  }
+  {
+    // The index is refreshed when closing a writable file.
+    File F(FILENAME, "r+");
+    F.use_persistent_index();
+    F.create_dataset("indexed_later", PredType::NATIVE_INT(), {2});
+  }
+  {
+    File F(FILENAME, "r+");
+    F.use_persistent_index();
+    assert(F.index().find("/indexed_later"));
+    // Not tracked (C API): the index isn't rewritten when closing the file.
+    hid_t space_id = H5Screate(H5S_SCALAR);
+    H5Dclose(H5Dcreate2(F.get_id(), "untracked", H5T_NATIVE_INT, space_id,
+                        H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT));
+    H5Sclose(space_id);
+  }
+  {
+    File F(FILENAME, "r+");
+    F.use_persistent_index();
+    assert(!F.index().find("/untracked"));
+    // Modification through another handle to the file.
+    F.open_group("mygroup").create_group("indexed_group");
+  }
+  {
+    File F(FILENAME, "r+");
+    F.use_persistent_index();
+    assert(F.index().find("/untracked"));
+    assert(F.index().find("/mygroup/indexed_group"));
+    // An index stored in another format is replaced.
+    auto g = F.open_group(ObjectIndex::persistent_path());
+    int old_version = 1;
+    g.open_attribute("format_version").write(&old_version);
+  }
+  {
+    File F(FILENAME, "r+");
+    F.use_persistent_index();  // rebuilt, since the format doesn't match
+    F.unlink("untracked");
+  }
+  {
+    // Datasets replaced through this library aren't opened by their stale
+    // address.
+    File F(FILENAME, "r+");
+    F.create_dataset("a", PredType::NATIVE_DOUBLE(), {10});
+    F.use_persistent_index(true);
+    assert(F.index().find("/a"));
+    H5Lcreate_hard(F.get_id(), "a", F.get_id(), "a_old", H5P_DEFAULT,
+                   H5P_DEFAULT);
+    F.unlink("a");
+    F.create_dataset("a", PredType::NATIVE_DOUBLE(), {100, 7});
+    assert(F.open_dataset("a").get_dataspace().size() == (dims_t{100, 7}));
+  }
+  File F(FILENAME, "r");
+  auto g = F.open_group(ObjectIndex::persistent_path());
+  assert(g.read_attribute<int>("format_version") ==
+         ObjectIndex::format_version());
+  F.use_persistent_index();
+  assert(F.index().find("/indexed_later") && !F.index().find("/untracked"));
+}
+
 void test_read() {
   using namespace HDF5;
   File F(FILENAME, "r");
@@ -93,6 +939,13 @@ void test_read() {
     auto space = a.get_dataspace();
     dims_t dims = space.size();
     assert(dims.size() == 2);
+    const auto ext = space.extent();
+    assert(ext.ndims() == 2 && ext[0] == 3 && ext[1] == 5 && space[1] == 5);
+    assert(ext.length() == 15 && ext.to_vector() == dims);
+    // Copies sharing the same id see changes of the extent.
+    auto s2 = space;
+    s2.set_extent({4, 6});
+    assert(space[0] == 4 && space.extent() != ext);
     if (space.ndims() == 2) {
       const double *p = x.data();
       std::cout << "x =\t[";
@@ -108,6 +961,24 @@ void test_read() {
     auto x = g.read_dataset<std::vector<float>>("dset2d");
     std::cout << "x[2] = " << x.at(2) << std::endl;
   }
+  {
+    // Read without zero-initialisation.
+    auto x = g.read_dataset<default_init_vector<double>>("dset2d");
+    assert(x.size() == 15 && x[14] == 3.2 * 14);
+    default_init_vector<double> y;
+    g.open_attribute("attr2d").read(y);
+    assert(std::equal(x.begin(), x.end(), y.begin()));
+  }
+  {
+    // Open dataset with custom chunk cache.
+    PropList::DSetAcc dapl;
+    dapl.set_chunk_cache(521, 16 << 20);
+    auto dset = g.open_dataset("chunked", dapl);
+    size_t nslots, nbytes;
+    H5Pget_chunk_cache(dset.get_access_plist().get_id(), &nslots, &nbytes,
+                       nullptr);
+    assert(nslots == 521 && nbytes == (16 << 20));
+  }
   {
     auto dset = g.open_dataset("mystr");  // refcount = 1
     {
@@ -133,11 +1004,41 @@ void test_read() {
   f3 = f2;
   assert(f3.filename() == FILENAME && f3.refcount() == 3);
   assert(f4.filename() == "aaaa.h5" && f4.refcount() == 1);
+
+  // Test moving handles (reference count is unchanged).
+  static_assert(std::is_nothrow_move_constructible<File>::value, "");
+  static_assert(std::is_nothrow_move_assignable<DataSet>::value, "");
+  File f5 = std::move(f3);
+  assert(f5.refcount() == 3 && f3.get_id() == IdComponent::INVALID_HID);
+  f4 = std::move(f5);
+  assert(f4.filename() == FILENAME && f4.refcount() == 3);
 }
 
 int main(int argc, char **argv) {
   test_write();
   test_read();
   test_fixed_string();
+  test_append();
+  test_direct_chunk();
+  test_chunked_writer();
+  test_map();
+  test_write_async();
+  test_static_dataspace();
+  test_multi_io();
+  test_io_stats();
+  test_handle_cache();
+  test_create_groups();
+  test_compound();
+  test_strings();
+  test_attributes();
+  test_index();
+  test_persistent_index();
+  test_parallel_reader();
+  test_slab_iterator();
+  test_auto_chunk();
+  test_filters();
+  test_drivers();
+  test_page_buffer();
+  test_gather();
   return 0;
 }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace HDF5 {
+
+/// Allocator that default-initialises elements instead of value-initialising
+/// them.
+///
+/// When used with std::vector, `resize(N)` leaves elements of trivial types
+/// (such as `double`) uninitialised, instead of setting them to zero. This
+/// avoids writing to the whole buffer before it is filled by a read
+/// operation.
+template <typename T, typename A = std::allocator<T>>
+class default_init_allocator : public A {
+  using traits = std::allocator_traits<A>;
+
+ public:
+  template <typename U>
+  struct rebind {
+    using other =
+        default_init_allocator<U, typename traits::template rebind_alloc<U>>;
+  };
+
+  using A::A;
+
+  /// Default-initialise element (called by std::vector::resize).
+  template <typename U>
+  void construct(U *ptr) noexcept(
+      std::is_nothrow_default_constructible<U>::value) {
+    ::new (static_cast<void *>(ptr)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *ptr, Args &&... args) {
+    traits::construct(static_cast<A &>(*this), ptr,
+                      std::forward<Args>(args)...);
+  }
+};
+
+/// std::vector whose elements are not zeroed on resize.
+///
+/// It can be passed to the `read` functions of DataSet and Attribute, so that
+/// the data is only written once to memory, by HDF5.
+template <typename T>
+using default_init_vector = std::vector<T, default_init_allocator<T>>;
+
+}  // namespace HDF5
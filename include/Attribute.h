@@ -1,9 +1,13 @@
 #pragma once
 
 #include "AbstractDataSet.h"
+#include "AttributeValue.h"
+#include "IOStats.h"
 #include "Location.h"
 #include "Object.h"
+#include "Strings.h"
 
+#include <exception>
 #include <type_traits>
 
 namespace HDF5 {
@@ -31,16 +35,25 @@ class Attribute : public Location, public AbstractDataSet {
   /// Try to close attribute.
   ~Attribute() { destruct(); }
 
+  /// Copy and move semantics are those of IdComponent.
+  Attribute(const Attribute &) = default;
+  Attribute &operator=(const Attribute &) = default;
+  Attribute(Attribute &&) = default;
+  Attribute &operator=(Attribute &&) = default;
+
   /// Close attribute (may throw exception).
   void close() override {
+    LibraryLock lock;
     if (H5Aclose(get_id()) < 0) throw Exception("Attribute::close");
     invalidate();
   }
 
-  DataType get_datatype() const override { return DataType(H5Aget_type(get_id())); }
+  DataType get_datatype() const override {
+    return DataType(LibraryLock::call(H5Aget_type, get_id()));
+  }
 
   DataSpace get_dataspace() const override {
-    return DataSpace(H5Aget_space(get_id()));
+    return DataSpace(LibraryLock::call(H5Aget_space, get_id()));
   }
 
   /// Write attribute data.
@@ -60,11 +73,15 @@ class Attribute : public Location, public AbstractDataSet {
   }
 
   /// Write data from std::vector.
-  template <typename T>
-  Attribute &write(const std::vector<T> &buf) {
+  template <typename T, typename Alloc>
+  Attribute &write(const std::vector<T, Alloc> &buf) {
     return write(buf.data(), PredType::get<T>());
   }
 
+  /// Write vector of strings (see DataSet::write for details).
+  template <typename Alloc>
+  Attribute &write(const std::vector<std::string, Alloc> &buf);
+
   /// Write std::string.
   Attribute &write(const std::string &buf) {
     const char *c_str = buf.c_str();
@@ -72,8 +89,14 @@ class Attribute : public Location, public AbstractDataSet {
   }
 
   Attribute &write(const void *buf, const DataType &mem_type) {
+    LibraryLock lock;
+    const bool timing = IOStats::timing_enabled();
+    const auto start = IOStats::start_timer(timing);
     if (H5Awrite(get_id(), mem_type.get_id(), buf) < 0)
       throw Exception("Attribute::write");
+    if (timing)
+      IOStats::record_transfer(get_id(), true, mem_type.get_id(), H5S_ALL,
+                               H5S_ALL, start);
     return *this;
   }
 
@@ -91,19 +114,33 @@ class Attribute : public Location, public AbstractDataSet {
   }
 
   /// Load data into std::vector.
-  template <typename T>
-  const Attribute &read(std::vector<T> &buf) const {
+  /// See DataSet::read for using a default_init_vector.
+  template <typename T, typename Alloc>
+  const Attribute &read(std::vector<T, Alloc> &buf) const {
     size_t N = get_dataspace().get_select_npoints();
     buf.resize(N);
     return read(buf.data(), PredType::get<T>());
   }
 
+  /// Load data into vector of strings (see DataSet::read for details).
+  template <typename Alloc>
+  const Attribute &read(std::vector<std::string, Alloc> &buf) const;
+
   /// Load data into std::string.
   const Attribute &read(std::string &buf) const;
 
+  /// Read attribute of any integer, floating point or string type.
+  AttributeValue read_value() const;
+
   const Attribute &read(void *buf, const DataType &mem_type) const {
+    LibraryLock lock;
+    const bool timing = IOStats::timing_enabled();
+    const auto start = IOStats::start_timer(timing);
     if (H5Aread(get_id(), mem_type.get_id(), buf) < 0)
       throw Exception("Attribute::read");
+    if (timing)
+      IOStats::record_transfer(get_id(), false, mem_type.get_id(), H5S_ALL,
+                               H5S_ALL, start);
     return *this;
   }
 };
@@ -113,6 +150,63 @@ class Attribute : public Location, public AbstractDataSet {
 // Function implementation.
 namespace HDF5 {
 
+template <typename Alloc>
+inline Attribute &Attribute::write(const std::vector<std::string, Alloc> &buf) {
+  auto dtype = get_datatype();
+  if (H5Tis_variable_str(dtype.get_id()) > 0) {
+    std::vector<const char *> ptrs;
+    ptrs.reserve(buf.size());
+    for (auto &s : buf) ptrs.push_back(s.c_str());
+    return write(ptrs.data(), dtype);
+  }
+  FixedStrings packed(buf, dtype.get_size());
+  return write(packed.data(), FixedStrings::memory_type(dtype));
+}
+
+template <typename Alloc>
+inline const Attribute &Attribute::read(
+    std::vector<std::string, Alloc> &buf) const {
+  auto dtype = get_datatype();
+  const size_t N = get_dataspace().get_select_npoints();
+  if (H5Tis_variable_str(dtype.get_id()) > 0) {
+    VLenStrings s(N, dtype);
+    read(s.data(), dtype);
+    s.to_vector(buf);
+  } else {
+    FixedStrings s(dtype.get_size(), N);
+    read(s.data(), FixedStrings::memory_type(dtype));
+    s.to_vector(buf);
+  }
+  return *this;
+}
+
+inline AttributeValue Attribute::read_value() const {
+  AttributeValue v;
+  auto dtype = get_datatype();
+  auto space = get_dataspace();
+  v._scalar = H5Sget_simple_extent_type(space.get_id()) == H5S_SCALAR;
+  const size_t N = space.get_select_npoints();
+  switch (H5Tget_class(dtype.get_id())) {
+    case H5T_INTEGER:
+      v._type = AttributeValue::INTEGER;
+      v._ints.resize(N);
+      read(v._ints.data(), PredType::NATIVE_INT64());
+      break;
+    case H5T_FLOAT:
+      v._type = AttributeValue::FLOAT;
+      v._floats.resize(N);
+      read(v._floats.data(), PredType::NATIVE_DOUBLE());
+      break;
+    case H5T_STRING:
+      v._type = AttributeValue::STRING;
+      read(v._strings);
+      break;
+    default:
+      break;
+  }
+  return v;
+}
+
 inline const Attribute &Attribute::read(std::string &buf) const {
   auto dtype = get_datatype();
   if (H5Tis_variable_str(dtype.get_id())) {
@@ -136,8 +230,8 @@ inline const Attribute &Attribute::read(std::string &buf) const {
 inline Attribute Object::create_attribute(const char *name,
                                           const DataType &type,
                                           const DataSpace &space) {
-  return Attribute(H5Acreate(get_id(), name, type.get_id(), space.get_id(),
-                             H5P_DEFAULT, H5P_DEFAULT));
+  return Attribute(LibraryLock::call(H5Acreate2, get_id(), name, type.get_id(),
+                                     space.get_id(), H5P_DEFAULT, H5P_DEFAULT));
 }
 
 inline Attribute Object::create_attribute(const std::string &name,
@@ -147,13 +241,100 @@ inline Attribute Object::create_attribute(const std::string &name,
 }
 
 inline Attribute Object::open_attribute(const char *name) const {
-  return Attribute(H5Aopen(get_id(), name, H5P_DEFAULT));
+  return Attribute(LibraryLock::call(H5Aopen, get_id(), name, H5P_DEFAULT));
 }
 
 inline Attribute Object::open_attribute(const std::string &name) const {
   return open_attribute(name.c_str());
 }
 
+inline std::vector<std::string> Object::attribute_names() const {
+  std::vector<std::string> names;
+  auto op = [](hid_t, const char *name, const H5A_info_t *, void *data) {
+    static_cast<std::vector<std::string> *>(data)->push_back(name);
+    return herr_t(0);
+  };
+  LibraryLock lock;
+  hsize_t idx = 0;
+  if (H5Aiterate2(get_id(), H5_INDEX_NAME, H5_ITER_INC, &idx, op, &names) < 0)
+    throw Exception("Object::attribute_names");
+  return names;
+}
+
+inline void Object::write_attributes(
+    const std::map<std::string, AttributeValue> &attrs) {
+  if (attrs.empty()) return;
+  LibraryLock lock;
+  for (auto &name : attribute_names())
+    if (attrs.count(name) && H5Adelete(get_id(), name.c_str()) < 0)
+      throw Exception("Object::write_attributes",
+                      "Error deleting attribute " + name);
+  const DataSpace scalar;
+  for (auto &kv : attrs) {
+    const auto &v = kv.second;
+    hsize_t N = v.size();
+    const DataType *type;
+    const void *buf;
+    std::vector<const char *> ptrs;
+    switch (v.type()) {
+      case AttributeValue::INTEGER:
+        type = &PredType::NATIVE_INT64();
+        buf = v._ints.data();
+        break;
+      case AttributeValue::FLOAT:
+        type = &PredType::NATIVE_DOUBLE();
+        buf = v._floats.data();
+        break;
+      case AttributeValue::STRING:
+        type = &PredType::STRING_UTF8_VLEN();
+        for (auto &s : v._strings) ptrs.push_back(s.c_str());
+        buf = ptrs.data();
+        break;
+      default:
+        throw Exception("Object::write_attributes",
+                        "Attribute " + kv.first + " has no value.");
+    }
+    auto attr = v.is_scalar() ? create_attribute(kv.first, *type, scalar)
+                              : create_attribute(kv.first, *type, {N});
+    attr.write(buf, *type);
+  }
+}
+
+inline std::map<std::string, AttributeValue> Object::read_all_attributes()
+    const {
+  struct Data {
+    std::map<std::string, AttributeValue> attrs;
+    std::exception_ptr error;
+  } data;
+  auto op = [](hid_t loc_id, const char *name, const H5A_info_t *,
+               void *ptr) -> herr_t {
+    auto &d = *static_cast<Data *>(ptr);
+    try {
+      Attribute attr(H5Aopen(loc_id, name, H5P_DEFAULT));
+      d.attrs[name] = attr.read_value();
+    } catch (...) {
+      // Exceptions can't propagate through the HDF5 library.
+      d.error = std::current_exception();
+      return -1;
+    }
+    return 0;
+  };
+  LibraryLock lock;
+  hsize_t idx = 0;
+  herr_t status =
+      H5Aiterate2(get_id(), H5_INDEX_NAME, H5_ITER_INC, &idx, op, &data);
+  if (data.error) std::rethrow_exception(data.error);
+  if (status < 0) throw Exception("Object::read_all_attributes");
+  return std::move(data.attrs);
+}
+
+inline std::map<std::string, AttributeValue> Object::read_attributes(
+    const std::vector<std::string> &names) const {
+  std::map<std::string, AttributeValue> attrs;
+  for (auto &name : names) attrs[name] = open_attribute(name).read_value();
+  return attrs;
+}
+
 template <typename T>
 inline Attribute Object::write_attribute(const T &val, const std::string &name,
                                          const DataSpace &space) {
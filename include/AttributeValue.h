@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Exception.h"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace HDF5 {
+
+/// Value of an attribute of arbitrary type, used to read and write many
+/// attributes at once (see Object::write_attributes and
+/// Object::read_all_attributes).
+///
+/// A value is either a scalar or a 1D array of integers, floating point
+/// numbers or strings. Integers are stored as `int64_t` and floating point
+/// numbers as `double`, and are written to the file with these types.
+/// Multidimensional attributes are read as flattened arrays.
+class AttributeValue {
+ public:
+  /// Kind of data held by the value.
+  enum Type { NONE, INTEGER, FLOAT, STRING };
+
+  /// Create empty value (of type NONE).
+  AttributeValue() = default;
+
+  /// Create scalar value.
+  template <typename T, typename std::enable_if<std::is_integral<T>::value,
+                                                int>::type = 0>
+  AttributeValue(T x) : _type(INTEGER), _scalar(true), _ints(1, x) {}
+
+  template <typename T, typename std::enable_if<
+                            std::is_floating_point<T>::value, int>::type = 0>
+  AttributeValue(T x) : _type(FLOAT), _scalar(true), _floats(1, x) {}
+
+  AttributeValue(const std::string &s)
+      : _type(STRING), _scalar(true), _strings(1, s) {}
+
+  AttributeValue(const char *s) : AttributeValue(std::string(s)) {}
+
+  /// Create 1D array value.
+  template <typename T, typename std::enable_if<std::is_integral<T>::value,
+                                                int>::type = 0>
+  AttributeValue(const std::vector<T> &x)
+      : _type(INTEGER), _ints(x.begin(), x.end()) {}
+
+  template <typename T, typename std::enable_if<
+                            std::is_floating_point<T>::value, int>::type = 0>
+  AttributeValue(const std::vector<T> &x)
+      : _type(FLOAT), _floats(x.begin(), x.end()) {}
+
+  AttributeValue(const std::vector<std::string> &x)
+      : _type(STRING), _strings(x) {}
+
+  Type type() const { return _type; }
+
+  /// Returns true if the value is a scalar (as opposed to an array).
+  bool is_scalar() const { return _scalar; }
+
+  /// Number of elements.
+  size_t size() const {
+    switch (_type) {
+      case INTEGER: return _ints.size();
+      case FLOAT: return _floats.size();
+      case STRING: return _strings.size();
+      default: return 0;
+    }
+  }
+
+  /// Returns scalar integer value.
+  int64_t as_int() const { return ints().at(0); }
+
+  /// Returns scalar floating point value (integers are converted).
+  double as_double() const {
+    if (_type == INTEGER) return double(as_int());
+    return doubles().at(0);
+  }
+
+  /// Returns scalar string value.
+  const std::string &as_string() const { return strings().at(0); }
+
+  const std::vector<int64_t> &ints() const {
+    _check(INTEGER);
+    return _ints;
+  }
+
+  const std::vector<double> &doubles() const {
+    _check(FLOAT);
+    return _floats;
+  }
+
+  const std::vector<std::string> &strings() const {
+    _check(STRING);
+    return _strings;
+  }
+
+  bool operator==(const AttributeValue &x) const {
+    return _type == x._type && _scalar == x._scalar && _ints == x._ints &&
+           _floats == x._floats && _strings == x._strings;
+  }
+  bool operator!=(const AttributeValue &x) const { return !(*this == x); }
+
+ private:
+  friend class Attribute;
+  friend class Object;
+
+  Type _type = NONE;
+  bool _scalar = false;
+  std::vector<int64_t> _ints;
+  std::vector<double> _floats;
+  std::vector<std::string> _strings;
+
+  void _check(Type type) const {
+    if (_type != type)
+      throw Exception("AttributeValue", "Value doesn't have requested type.");
+  }
+};
+
+}  // namespace HDF5
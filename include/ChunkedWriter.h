@@ -0,0 +1,335 @@
+#pragma once
+
+#include "DataSet.h"
+
+#if H5_VERSION_GE(1, 10, 2)
+
+#if defined(H5_HAVE_FILTER_DEFLATE) && defined(H5_HAVE_ZLIB_H)
+#include <zlib.h>
+#define HDF5MM_HAVE_ZLIB
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>  // memcpy
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace HDF5 {
+
+/// Writes a chunked dataset by filtering its chunks on multiple threads.
+///
+/// A full in-memory array is split into chunks according to the chunk
+/// dimensions of the dataset. Each chunk is filtered by a codec on one of the
+/// worker threads, and the filtered chunks are then written in order by the
+/// calling thread using direct chunk writes (see DataSet::write_chunk). The
+/// HDF5 library is only called from the calling thread.
+///
+/// The codec must reproduce the filter pipeline of the dataset creation
+/// property list (for instance, set_shuffle() followed by set_deflate(level)
+/// corresponds to the codec shuffle_deflate(level)).
+///
+/// Example:
+///
+///     PropList::DSetCreat dcpl;
+///     dcpl.set_chunk({64, 64, 64}).set_shuffle().set_deflate(4);
+///     auto dset = file.create_dataset("u", PredType::NATIVE_DOUBLE(),
+///                                     {N, N, N}, dcpl);
+///     ChunkedWriter writer(dset, ChunkedWriter::shuffle_deflate(4));
+///     writer.write(u);  // u: std::vector<double> of size N^3
+///
+class ChunkedWriter {
+ public:
+  /// Filters a chunk in place.
+  ///
+  /// The first argument contains the raw chunk data on input, and the filtered
+  /// data on output. The second argument is the size in bytes of a dataset
+  /// element. Returns the filter mask of the chunk (see DataSet::write_chunk).
+  using Codec = std::function<uint32_t(std::vector<char> &, size_t)>;
+
+  /// Create writer for chunked dataset.
+  ///
+  /// If `nthreads` is zero, the number of threads is set to the number of
+  /// hardware threads.
+  ChunkedWriter(const DataSet &dset, Codec codec, unsigned nthreads = 0)
+      : _dset(dset),
+        _codec(std::move(codec)),
+        _nthreads(nthreads ? nthreads : std::thread::hardware_concurrency()),
+        _dims(dset.get_dataspace().size()),
+        _chunk(dset.get_create_plist().get_chunk()) {
+    if (_chunk.empty())
+      throw Exception("ChunkedWriter::ChunkedWriter",
+                      "Dataset must have chunked layout.");
+    if (_nthreads == 0) _nthreads = 1;
+  }
+
+  /// Codec for datasets without filters.
+  static Codec identity() {
+    return [](std::vector<char> &, size_t) -> uint32_t { return 0; };
+  }
+
+  /// Codec for the shuffle filter (DSetCreat::set_shuffle).
+  static Codec shuffle() {
+    return [](std::vector<char> &buf, size_t type_size) -> uint32_t {
+      _shuffle(buf, type_size);
+      return 0;
+    };
+  }
+
+#ifdef HDF5MM_HAVE_ZLIB
+  /// Codec for the deflate filter (DSetCreat::set_deflate).
+  static Codec deflate(unsigned level) {
+    return [level](std::vector<char> &buf, size_t) -> uint32_t {
+      _deflate(buf, level);
+      return 0;
+    };
+  }
+
+  /// Codec for the shuffle filter followed by the deflate filter.
+  static Codec shuffle_deflate(unsigned level) {
+    return [level](std::vector<char> &buf, size_t type_size) -> uint32_t {
+      _shuffle(buf, type_size);
+      _deflate(buf, level);
+      return 0;
+    };
+  }
+#endif  // HDF5MM_HAVE_ZLIB
+
+  /// Set maximum number of filtered chunks waiting to be written.
+  ///
+  /// This bounds the memory used by the writer. By default, it is four times
+  /// the number of threads.
+  ChunkedWriter &set_max_pending(size_t n) {
+    _max_pending = n;
+    return *this;
+  }
+
+  /// Write full array to the dataset.
+  template <typename T>
+  ChunkedWriter &write(const T *buf) {
+    return write(buf, PredType::get<T>());
+  }
+
+  /// Write full array from std::vector.
+  template <typename T, typename Alloc>
+  ChunkedWriter &write(const std::vector<T, Alloc> &buf) {
+    size_t N = 1;
+    for (auto n : _dims) N *= n;
+    if (buf.size() != N)
+      throw Exception("ChunkedWriter::write",
+                      "Vector length must match the dataset size.");
+    return write(buf.data(), PredType::get<T>());
+  }
+
+  /// Write full array with the given memory datatype.
+  ///
+  /// Since chunks bypass the datatype conversion of HDF5, the memory datatype
+  /// must be the same as the dataset datatype.
+  ChunkedWriter &write(const void *buf, const DataType &mem_type);
+
+ private:
+  /// Filtered chunk waiting to be written.
+  struct Slot {
+    std::vector<char> data;
+    uint32_t filter_mask = 0;
+    bool ready = false;
+  };
+
+  DataSet _dset;
+  Codec _codec;
+  unsigned _nthreads;
+  size_t _max_pending = 0;
+
+  /// Dataset and chunk dimensions.
+  dims_t _dims;
+  dims_t _chunk;
+
+  /// Copy chunk `k` (in row-major order of the chunk grid) from the full array
+  /// into `out`. Elements outside of the dataset are set to zero.
+  void _extract_chunk(const char *buf, size_t type_size, size_t k,
+                      const dims_t &grid, dims_t &offset,
+                      std::vector<char> &out) const;
+
+  /// Byte shuffle, as done by the HDF5 shuffle filter.
+  static void _shuffle(std::vector<char> &buf, size_t type_size) {
+    const size_t N = buf.size() / type_size;
+    if (type_size <= 1 || N <= 1) return;
+    std::vector<char> out(buf.size());
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < type_size; ++j)
+        out[j * N + i] = buf[i * type_size + j];
+    // Trailing bytes (if any) are left unchanged.
+    std::copy(buf.begin() + N * type_size, buf.end(),
+              out.begin() + N * type_size);
+    buf.swap(out);
+  }
+
+#ifdef HDF5MM_HAVE_ZLIB
+  /// Zlib compression, as done by the HDF5 deflate filter.
+  static void _deflate(std::vector<char> &buf, unsigned level) {
+    uLongf size = compressBound(buf.size());
+    std::vector<char> out(size);
+    if (compress2(reinterpret_cast<Bytef *>(out.data()), &size,
+                  reinterpret_cast<const Bytef *>(buf.data()), buf.size(),
+                  level) != Z_OK)
+      throw Exception("ChunkedWriter::_deflate", "Compression failed.");
+    out.resize(size);
+    buf.swap(out);
+  }
+#endif  // HDF5MM_HAVE_ZLIB
+};
+
+}  // namespace HDF5
+
+// Function implementation.
+namespace HDF5 {
+
+inline void ChunkedWriter::_extract_chunk(const char *buf, size_t type_size,
+                                          size_t k, const dims_t &grid,
+                                          dims_t &offset,
+                                          std::vector<char> &out) const {
+  const size_t rank = _dims.size();
+
+  // Offset of the chunk in the dataset.
+  for (size_t d = rank; d-- > 0;) {
+    offset[d] = (k % grid[d]) * _chunk[d];
+    k /= grid[d];
+  }
+
+  size_t chunk_points = 1;
+  for (auto n : _chunk) chunk_points *= n;
+  out.assign(chunk_points * type_size, 0);
+
+  // Number of elements of the chunk that are within the dataset, and number
+  // of contiguous rows (along the last dimension) to copy.
+  dims_t count(rank);
+  size_t nrows = 1;
+  for (size_t d = 0; d < rank; ++d) {
+    count[d] = std::min(_chunk[d], _dims[d] - offset[d]);
+    if (d + 1 < rank) nrows *= count[d];
+  }
+  const size_t row_bytes = count[rank - 1] * type_size;
+
+  dims_t idx(rank, 0);  // index of current row within the chunk
+  for (size_t r = 0; r < nrows; ++r) {
+    // Linear indices of the row start in the array and in the chunk.
+    size_t src = 0, dst = 0;
+    for (size_t d = 0; d < rank; ++d) {
+      src = src * _dims[d] + offset[d] + idx[d];
+      dst = dst * _chunk[d] + idx[d];
+    }
+    std::memcpy(out.data() + dst * type_size, buf + src * type_size,
+                row_bytes);
+    // Increment row index (the last dimension is fixed at zero).
+    for (size_t d = rank - 1; d-- > 0;) {
+      if (++idx[d] < count[d]) break;
+      idx[d] = 0;
+    }
+  }
+}
+
+inline ChunkedWriter &ChunkedWriter::write(const void *buf,
+                                           const DataType &mem_type) {
+  if (mem_type != _dset.get_datatype())
+    throw Exception("ChunkedWriter::write",
+                    "Memory datatype must match the dataset datatype.");
+  const size_t type_size = mem_type.get_size();
+  const size_t rank = _dims.size();
+  const char *data = static_cast<const char *>(buf);
+
+  // Dimensions of the chunk grid.
+  dims_t grid(rank);
+  size_t nchunks = 1;
+  for (size_t d = 0; d < rank; ++d) {
+    grid[d] = (_dims[d] + _chunk[d] - 1) / _chunk[d];
+    nchunks *= grid[d];
+  }
+  if (nchunks == 0) return *this;
+
+  const size_t max_pending = _max_pending ? _max_pending : 4 * _nthreads;
+  std::vector<Slot> slots(nchunks);
+  std::mutex mutex;
+  std::condition_variable cv_ready, cv_space;
+  size_t next_task = 0;   // next chunk to be filtered
+  size_t next_write = 0;  // next chunk to be written
+  bool abort = false;
+  std::exception_ptr error;
+
+  auto worker = [&]() {
+    std::vector<char> chunk;
+    dims_t offset(rank);
+    while (true) {
+      size_t k;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv_space.wait(lock, [&] {
+          return abort || next_task >= nchunks ||
+                 next_task < next_write + max_pending;
+        });
+        if (abort || next_task >= nchunks) return;
+        k = next_task++;
+      }
+      uint32_t mask = 0;
+      try {
+        _extract_chunk(data, type_size, k, grid, offset, chunk);
+        mask = _codec(chunk, type_size);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+        abort = true;
+        cv_ready.notify_all();
+        cv_space.notify_all();
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      slots[k].data.swap(chunk);
+      slots[k].filter_mask = mask;
+      slots[k].ready = true;
+      cv_ready.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned n = 0; n < _nthreads; ++n) threads.emplace_back(worker);
+
+  // Write chunks in order from the calling thread.
+  try {
+    dims_t offset(rank);
+    for (size_t k = 0; k < nchunks; ++k) {
+      std::vector<char> chunk;
+      uint32_t mask;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv_ready.wait(lock, [&] { return abort || slots[k].ready; });
+        if (abort) break;
+        chunk.swap(slots[k].data);
+        mask = slots[k].filter_mask;
+      }
+      size_t j = k;
+      for (size_t d = rank; d-- > 0;) {
+        offset[d] = (j % grid[d]) * _chunk[d];
+        j /= grid[d];
+      }
+      _dset.write_chunk(offset, chunk, mask);
+      std::lock_guard<std::mutex> lock(mutex);
+      ++next_write;
+      cv_space.notify_all();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error) error = std::current_exception();
+    abort = true;
+    cv_space.notify_all();
+  }
+
+  for (auto &t : threads) t.join();
+  if (error) std::rethrow_exception(error);
+  return *this;
+}
+
+}  // namespace HDF5
+
+#endif  // H5_VERSION_GE(1, 10, 2)
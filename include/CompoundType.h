@@ -0,0 +1,215 @@
+#pragma once
+
+#include "DataType.h"
+
+#include <array>
+#include <cstddef>  // offsetof
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace HDF5 {
+
+/// Compound datatype associated to a C++ struct.
+///
+/// The members of the struct are registered with the HDF5MM_COMPOUND_TYPE
+/// macro, which must be used at global scope:
+///
+///     struct Particle {
+///       double x[3];
+///       float mass;
+///       int64_t id;
+///     };
+///     HDF5MM_COMPOUND_TYPE(Particle, x, mass, id);
+///
+/// The HDF5 datatype is created on first use and then cached, like the
+/// predefined types. After registration, `PredType::get<Particle>()` returns
+/// the compound type, so that a `std::vector<Particle>` can be written and
+/// read in a single contiguous transfer (e.g. with Group::write_dataset).
+///
+/// Members may be of any type known to PredType::get (including other
+/// registered compound types), or fixed-size arrays (`T[N]` or
+/// `std::array<T, N>`) of such types. The struct must have standard layout.
+///
+/// See <https://portal.hdfgroup.org/display/HDF5/H5T_CREATE>.
+template <typename T>
+class CompoundType : public PredType {
+ public:
+  /// Returns the compound type associated to T.
+  static const CompoundType &instance() {
+    static CompoundType type(LibraryLock::call(_create));
+    return type;
+  }
+
+  /// Create compound type with a subset of the members of T.
+  ///
+  /// The returned type has the same size and member offsets as T, so it can
+  /// be used as a memory datatype to read or write only the given members of
+  /// an array of T (see DataSet::read_fields).
+  DataType subset(const std::vector<std::string> &names) const {
+    DataType sub = H5Tcreate(H5T_COMPOUND, sizeof(T));
+    if (!sub.is_valid()) throw Exception("CompoundType::subset");
+    for (auto &name : names) {
+      int i = H5Tget_member_index(get_id(), name.c_str());
+      if (i < 0)
+        throw Exception("CompoundType::subset", "Unknown member: " + name);
+      DataType member = H5Tget_member_type(get_id(), i);
+      if (H5Tinsert(sub.get_id(), name.c_str(),
+                    H5Tget_member_offset(get_id(), i), member.get_id()) < 0)
+        throw Exception("CompoundType::subset",
+                        "Error inserting member " + name);
+    }
+    return sub;
+  }
+
+ protected:
+  CompoundType(hid_t type_id) : PredType(type_id) {}
+
+  /// Create HDF5 compound type (defined by HDF5MM_COMPOUND_TYPE).
+  static hid_t _create();
+
+  /// Datatype of a struct member (the caller must close it).
+  template <typename M>
+  struct _Member {
+    static hid_t create() { return H5Tcopy(PredType::get<M>().get_id()); }
+  };
+
+  template <typename M, size_t N>
+  struct _Member<M[N]> {
+    static hid_t create() { return _array_type(_Member<M>::create(), N); }
+  };
+
+  template <typename M, size_t N>
+  struct _Member<std::array<M, N>> {
+    static hid_t create() { return _array_type(_Member<M>::create(), N); }
+  };
+
+  /// Create 1D array datatype and close the base datatype.
+  static hid_t _array_type(hid_t base_id, hsize_t n) {
+    hid_t id = H5Tarray_create2(base_id, 1, &n);
+    H5Tclose(base_id);
+    return id;
+  }
+
+  /// Add member to compound type.
+  template <typename M>
+  static void _insert(hid_t type_id, const char *name, size_t offset) {
+    hid_t member_id = _Member<M>::create();
+    herr_t status =
+        member_id < 0 ? -1 : H5Tinsert(type_id, name, offset, member_id);
+    if (member_id >= 0) H5Tclose(member_id);
+    if (status < 0)
+      throw Exception("CompoundType::_insert",
+                      std::string("Error inserting member ") + name);
+  }
+};
+
+}  // namespace HDF5
+
+// Helper macros for applying a macro to each member name (up to 32 members).
+#define HDF5MM_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12,      \
+  _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27,  \
+  _28, _29, _30, _31, _32, N, ...) N
+#define HDF5MM_NARGS(...) HDF5MM_NARGS_(__VA_ARGS__, 32, 31, 30, 29, 28, 27,  \
+  26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8,   \
+  7, 6, 5, 4, 3, 2, 1)
+#define HDF5MM_CONCAT_(a, b) a##b
+#define HDF5MM_CONCAT(a, b) HDF5MM_CONCAT_(a, b)
+#define HDF5MM_FOR_EACH(m, ...)                                               \
+  HDF5MM_CONCAT(HDF5MM_FOR_EACH_, HDF5MM_CONCAT(HDF5MM_NARGS(__VA_ARGS__), _)) \
+  (m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_1_(m, x) m(x)
+#define HDF5MM_FOR_EACH_2_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_1_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_3_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_2_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_4_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_3_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_5_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_4_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_6_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_5_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_7_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_6_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_8_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_7_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_9_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_8_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_10_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_9_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_11_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_10_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_12_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_11_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_13_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_12_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_14_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_13_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_15_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_14_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_16_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_15_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_17_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_16_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_18_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_17_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_19_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_18_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_20_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_19_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_21_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_20_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_22_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_21_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_23_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_22_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_24_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_23_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_25_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_24_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_26_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_25_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_27_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_26_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_28_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_27_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_29_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_28_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_30_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_29_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_31_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_30_(m, __VA_ARGS__)
+#define HDF5MM_FOR_EACH_32_(m, x, ...) \
+  m(x) HDF5MM_FOR_EACH_31_(m, __VA_ARGS__)
+
+#define HDF5MM_COMPOUND_MEMBER_(member)                                       \
+  _insert<decltype(compound_type::member)>(type_id, #member,                  \
+                                           offsetof(compound_type, member));
+
+/// Register compound datatype for struct `Type` with the given members (see
+/// CompoundType). Must be used at global scope. Member names must be given
+/// in the order in which they should appear in the file.
+#define HDF5MM_COMPOUND_TYPE(Type, ...)                                       \
+  namespace HDF5 {                                                            \
+  template <>                                                                 \
+  inline hid_t CompoundType<Type>::_create() {                                \
+    using compound_type = Type;                                               \
+    static_assert(std::is_standard_layout<compound_type>::value,              \
+                  "Compound types must have standard layout.");               \
+    hid_t type_id = H5Tcreate(H5T_COMPOUND, sizeof(compound_type));           \
+    if (type_id < 0) throw Exception("CompoundType::_create");                \
+    try {                                                                     \
+      HDF5MM_FOR_EACH(HDF5MM_COMPOUND_MEMBER_, __VA_ARGS__)                   \
+    } catch (...) {                                                           \
+      H5Tclose(type_id);                                                      \
+      throw;                                                                  \
+    }                                                                         \
+    return type_id;                                                           \
+  }                                                                           \
+                                                                              \
+  template <>                                                                 \
+  inline const PredType &PredType::get<Type>() {                              \
+    return CompoundType<Type>::instance();                                    \
+  }                                                                           \
+  }                                                                           \
+  static_assert(true, "")  // this is just to require a semicolon
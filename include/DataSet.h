@@ -1,13 +1,33 @@
 #pragma once
 
 #include "AbstractDataSet.h"
+#include "CompoundType.h"
+#include "IOStats.h"
 #include "Object.h"
+#include "ObjectIndex.h"
 #include "PropList.h"
+#include "Strings.h"
+
+#include <algorithm>
+#include <functional>  // greater_equal
+#include <future>
+#include <memory>
+#include <utility>  // pair
+
+#if defined(HDF5MM_USE_EVENT_SETS) && !H5_VERSION_GE(1, 13, 0)
+#error "HDF5MM_USE_EVENT_SETS requires HDF5 >= 1.13."
+#endif
 
 namespace HDF5 {
 
+template <typename T>
+class MappedArray;
+
 class DataSet : public Object, public AbstractDataSet {
  public:
+  struct WriteRequest;
+  struct ReadRequest;
+
   /// Default constructor.
   DataSet() = default;
 
@@ -17,16 +37,25 @@ class DataSet : public Object, public AbstractDataSet {
   /// Try to close DataSet.
   ~DataSet() { destruct(); }
 
+  /// Copy and move semantics are those of IdComponent.
+  DataSet(const DataSet &) = default;
+  DataSet &operator=(const DataSet &) = default;
+  DataSet(DataSet &&) = default;
+  DataSet &operator=(DataSet &&) = default;
+
   /// Close dataset.
   void close() override {
+    LibraryLock lock;
     if (H5Dclose(get_id()) < 0) throw Exception("DataSet::close");
     invalidate();
   }
 
-  DataType get_datatype() const override { return DataType(H5Dget_type(get_id())); }
+  DataType get_datatype() const override {
+    return DataType(LibraryLock::call(H5Dget_type, get_id()));
+  }
 
   DataSpace get_dataspace() const override {
-    return DataSpace(H5Dget_space(get_id()));
+    return DataSpace(LibraryLock::call(H5Dget_space, get_id()));
   }
 
   /// Write dataset data.
@@ -52,15 +81,36 @@ class DataSet : public Object, public AbstractDataSet {
   }
 
   /// Write data from std::vector.
-  template <typename T>
+  template <typename T, typename Alloc>
   DataSet &write(
-      const std::vector<T> &buf, const DataSpace &mem_space = DataSpace::ALL(),
+      const std::vector<T, Alloc> &buf,
+      const DataSpace &mem_space = DataSpace::ALL(),
       const DataSpace &file_space = DataSpace::ALL(),
       const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
     return write(buf.data(), PredType::get<T>(), mem_space, file_space,
                  xfer_plist);
   }
 
+  /// Write vector of strings.
+  ///
+  /// For variable-length string datasets, pointers to all the strings are
+  /// passed to a single `H5Dwrite` call. For fixed-length string datasets,
+  /// the strings are first packed into a contiguous buffer (see
+  /// FixedStrings), and an exception is thrown if a string is longer than the
+  /// size of the datatype.
+  template <typename Alloc>
+  DataSet &write(
+      const std::vector<std::string, Alloc> &buf,
+      const DataSpace &mem_space = DataSpace::ALL(),
+      const DataSpace &file_space = DataSpace::ALL(),
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT());
+
+  /// Write strings from a contiguous fixed-width buffer.
+  DataSet &write(
+      const FixedStrings &buf, const DataSpace &mem_space = DataSpace::ALL(),
+      const DataSpace &file_space = DataSpace::ALL(),
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT());
+
   /// Write std::string.
   DataSet &write(
       const std::string &buf, const DataSpace &mem_space = DataSpace::ALL(),
@@ -76,12 +126,113 @@ class DataSet : public Object, public AbstractDataSet {
       const DataSpace &mem_space = DataSpace::ALL(),
       const DataSpace &file_space = DataSpace::ALL(),
       const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
+    LibraryLock lock;
+    const bool timing = IOStats::timing_enabled();
+    const auto start = IOStats::start_timer(timing);
     herr_t status = H5Dwrite(get_id(), mem_type.get_id(), mem_space.get_id(),
                              file_space.get_id(), xfer_plist.get_id(), buf);
     if (status < 0) throw Exception("DataSet::write");
+    if (timing)
+      IOStats::record_transfer(get_id(), true, mem_type.get_id(),
+                               mem_space.get_id(), file_space.get_id(), start);
+#ifdef H5_HAVE_PARALLEL
+    if (IOStats::mpio_enabled())
+      IOStats::record_mpio(get_id(), xfer_plist.get_id());
+#endif
+    return *this;
+  }
+
+  /// Write data from std::vector asynchronously.
+  ///
+  /// The returned future becomes ready when the write is complete, and
+  /// rethrows any error from the write when calling `get()`. If it's
+  /// destroyed before, its destructor waits for the write. The vector is
+  /// owned by the write operation: pass it with `std::move` to avoid a
+  /// copy. The dataspaces are copied, so that their selections may be
+  /// modified after the call. The transfer property list is shared and must
+  /// not be modified until the write is complete.
+  ///
+  /// If HDF5MM_USE_EVENT_SETS is defined (requires HDF5 >= 1.13), the write is
+  /// submitted to an event set with H5Dwrite_async. This is only asynchronous
+  /// if an asynchronous VOL connector is in use. Otherwise, if handles may be
+  /// shared across threads (see LibraryLock::thread_safe), the write is done
+  /// in a background thread. If none of these is available, the write is
+  /// done synchronously.
+  ///
+  /// In parallel builds, a collective background write requires MPI to be
+  /// initialised with `MPI_THREAD_MULTIPLE`.
+  template <typename T, typename Alloc>
+  std::future<void> write_async(
+      std::vector<T, Alloc> buf,
+      const DataSpace &mem_space = DataSpace::ALL(),
+      const DataSpace &file_space = DataSpace::ALL(),
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT());
+
+  /// Change the dimensions of the dataset.
+  ///
+  /// The dataset must be chunked, and the new dimensions must not exceed the
+  /// maximum dimensions of its dataspace. Note that shrinking a dataset
+  /// discards the data outside the new extent.
+  DataSet &set_extent(const hsize_t *dims) {
+    if (LibraryLock::call(H5Dset_extent, get_id(), dims) < 0)
+      throw Exception("DataSet::set_extent");
+    ObjectIndex::mark_modified(get_id());
     return *this;
   }
 
+  DataSet &set_extent(const dims_t &dims) { return set_extent(dims.data()); }
+
+  template <size_t N>
+  DataSet &set_extent(const adims_t<N> &dims) {
+    return set_extent(dims.data());
+  }
+
+  /// Extend the dataset by `n` elements along dimension `axis`.
+  DataSet &extend(hsize_t n, int axis = 0) {
+    auto dims = get_dataspace().size();
+    if (axis < 0 || axis >= int(dims.size()))
+      throw Exception("DataSet::extend", "Invalid dimension index.");
+    dims[axis] += n;
+    return set_extent(dims);
+  }
+
+  /// Append records along the first dimension of the dataset.
+  ///
+  /// A record is a slice of the dataset with fixed first index. For instance,
+  /// for a dataset of dimensions (N, M), each record contains M elements, and
+  /// `buf` must contain `nrecords * M` elements.
+  ///
+  /// The current extent is queried on each call, so that appends through
+  /// different handles to the same dataset don't overwrite each other.
+  template <typename T>
+  DataSet &append(
+      const T *buf, hsize_t nrecords = 1,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
+    return append(buf, PredType::get<T>(), nrecords, xfer_plist);
+  }
+
+  /// Append data from std::vector.
+  /// The number of records is inferred from the vector length.
+  template <typename T, typename Alloc>
+  DataSet &append(
+      const std::vector<T, Alloc> &buf,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
+    const dims_t dims = _append_extent();
+    hsize_t record_size = 1;
+    for (size_t i = 1; i < dims.size(); ++i) record_size *= dims[i];
+    if (record_size == 0 || buf.size() % record_size != 0)
+      throw Exception("DataSet::append",
+                      "Vector length is not a multiple of the record size.");
+    return _append(buf.data(), PredType::get<T>(), buf.size() / record_size,
+                   dims, xfer_plist);
+  }
+
+  DataSet &append(
+      const void *buf, const DataType &mem_type, hsize_t nrecords = 1,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
+    return _append(buf, mem_type, nrecords, _append_extent(), xfer_plist);
+  }
+
   /// Read dataset data.
   template <typename T>
   const DataSet &read(
@@ -101,9 +252,13 @@ class DataSet : public Object, public AbstractDataSet {
   }
 
   /// Load data into std::vector.
-  template <typename T>
+  ///
+  /// The vector is resized to the number of selected points. To avoid
+  /// zeroing the vector before reading, use a default_init_vector.
+  template <typename T, typename Alloc>
   const DataSet &read(
-      std::vector<T> &buf, const DataSpace &mem_space = DataSpace::ALL(),
+      std::vector<T, Alloc> &buf,
+      const DataSpace &mem_space = DataSpace::ALL(),
       const DataSpace &file_space = DataSpace::ALL(),
       const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const {
     // Determine number of points from dataspace.
@@ -117,6 +272,75 @@ class DataSet : public Object, public AbstractDataSet {
                 xfer_plist);
   }
 
+  /// Load data into vector of strings.
+  ///
+  /// For variable-length strings, all strings are read with a single call to
+  /// `H5Dread` and then released at once by HDF5 (see VLenStrings). For
+  /// fixed-length strings, the data is read into a contiguous buffer (see
+  /// FixedStrings). The vector is resized to the number of selected points.
+  template <typename Alloc>
+  const DataSet &read(
+      std::vector<std::string, Alloc> &buf,
+      const DataSpace &mem_space = DataSpace::ALL(),
+      const DataSpace &file_space = DataSpace::ALL(),
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const;
+
+  /// Load strings into a contiguous fixed-width buffer.
+  ///
+  /// For fixed-length string datasets, the width is the size of the
+  /// datatype. For variable-length strings, it is the length of the longest
+  /// string that was read.
+  const DataSet &read(
+      FixedStrings &buf, const DataSpace &mem_space = DataSpace::ALL(),
+      const DataSpace &file_space = DataSpace::ALL(),
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const;
+
+  /// Read a subset of the members of a compound dataset.
+  ///
+  /// T must be a registered compound type (see CompoundType). Only the
+  /// members listed in `names` are converted and copied into `buf`; other
+  /// members of its elements are left unchanged (or uninitialised, if the
+  /// vector is resized). As with read(std::vector&), the vector is resized to
+  /// the number of selected points.
+  template <typename T, typename Alloc>
+  const DataSet &read_fields(
+      const std::vector<std::string> &names, std::vector<T, Alloc> &buf,
+      const DataSpace &mem_space = DataSpace::ALL(),
+      const DataSpace &file_space = DataSpace::ALL(),
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const;
+
+  /// Read a single member of a compound dataset into a contiguous array.
+  ///
+  /// This converts an array of structs in the file into one array of the
+  /// struct of arrays in memory (e.g. `read_field("mass", masses)`). The
+  /// datatype of the member must be convertible to T.
+  template <typename T, typename Alloc>
+  const DataSet &read_field(
+      const std::string &name, std::vector<T, Alloc> &buf,
+      const DataSpace &mem_space = DataSpace::ALL(),
+      const DataSpace &file_space = DataSpace::ALL(),
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const;
+
+  /// Read scattered entries along the first dimension.
+  ///
+  /// For a 1D dataset, `out[i]` is set to element `indices[i]`. For an N-D
+  /// dataset, each index selects a whole row (the slice with that index along
+  /// the first dimension), and rows are stored contiguously in `out`, which
+  /// is resized to `indices.size()` rows. Indices may be unsorted and
+  /// repeated.
+  ///
+  /// Indices are sorted and merged into runs of consecutive indices, which
+  /// are read as unions of hyperslabs, with one contiguous access per run.
+  /// Runs are read in batches of 32 runs per operation, so that the cost of
+  /// building the selections remains linear in the number of runs. 1D reads
+  /// of mostly isolated indices use a single point selection instead. The
+  /// number of read operations depends on the indices, so collective
+  /// transfers are only possible if it's the same on all processes.
+  template <typename T, typename Alloc>
+  const DataSet &gather(
+      const std::vector<hsize_t> &indices, std::vector<T, Alloc> &out,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const;
+
   /// Load data into std::string.
   const DataSet &read(
       std::string &buf, const DataSpace &mem_space = DataSpace::ALL(),
@@ -128,18 +352,232 @@ class DataSet : public Object, public AbstractDataSet {
       const DataSpace &mem_space = DataSpace::ALL(),
       const DataSpace &file_space = DataSpace::ALL(),
       const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const {
+    LibraryLock lock;
+    const bool timing = IOStats::timing_enabled();
+    const auto start = IOStats::start_timer(timing);
     herr_t status = H5Dread(get_id(), mem_type.get_id(), mem_space.get_id(),
                             file_space.get_id(), xfer_plist.get_id(), buf);
     if (status < 0) throw Exception("DataSet::read");
+    if (timing)
+      IOStats::record_transfer(get_id(), false, mem_type.get_id(),
+                               mem_space.get_id(), file_space.get_id(), start);
+#ifdef H5_HAVE_PARALLEL
+    if (IOStats::mpio_enabled())
+      IOStats::record_mpio(get_id(), xfer_plist.get_id());
+#endif
+    return *this;
+  }
+
+#if H5_VERSION_GE(1, 10, 2)
+  /// Write raw chunk directly to the file, bypassing the filter pipeline.
+  ///
+  /// `offset` contains the logical position of the first element of the
+  /// chunk in the dataset (it must be a multiple of the chunk size). The
+  /// chunk data in `buf` (of `size` bytes) must already have been processed
+  /// by the filters of the dataset. Bit `i` of `filter_mask` is set if the
+  /// `i`-th filter of the pipeline was *not* applied to the chunk.
+  ///
+  /// Note that direct chunk I/O is not supported by parallel HDF5.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5D_WRITE_CHUNK>.
+  DataSet &write_chunk(
+      const hsize_t *offset, const void *buf, size_t size,
+      uint32_t filter_mask = 0,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
+    if (LibraryLock::call(H5Dwrite_chunk, get_id(), xfer_plist.get_id(),
+                          filter_mask, offset, size, buf) < 0)
+      throw Exception("DataSet::write_chunk");
     return *this;
   }
 
+  DataSet &write_chunk(
+      const dims_t &offset, const std::vector<char> &buf,
+      uint32_t filter_mask = 0,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
+    return write_chunk(offset.data(), buf.data(), buf.size(), filter_mask,
+                       xfer_plist);
+  }
+
+  /// Get size in bytes of a raw chunk as stored in the file.
+  hsize_t get_chunk_storage_size(const hsize_t *offset) const {
+    hsize_t size;
+    if (LibraryLock::call(H5Dget_chunk_storage_size, get_id(), offset,
+                          &size) < 0)
+      throw Exception("DataSet::get_chunk_storage_size");
+    return size;
+  }
+
+  hsize_t get_chunk_storage_size(const dims_t &offset) const {
+    return get_chunk_storage_size(offset.data());
+  }
+
+  /// Read raw chunk directly from the file, bypassing the filter pipeline.
+  ///
+  /// The buffer must be large enough to hold the chunk as stored in the file
+  /// (see get_chunk_storage_size). If `filter_mask` is not null, it is set to
+  /// the filter mask of the chunk (see write_chunk).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5D_READ_CHUNK>.
+  const DataSet &read_chunk(
+      const hsize_t *offset, void *buf, uint32_t *filter_mask = nullptr,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const {
+    uint32_t mask;
+    if (LibraryLock::call(H5Dread_chunk, get_id(), xfer_plist.get_id(),
+                          offset, &mask, buf) < 0)
+      throw Exception("DataSet::read_chunk");
+    if (filter_mask) *filter_mask = mask;
+    return *this;
+  }
+
+  /// Load raw chunk into std::vector.
+  /// The vector is resized to the storage size of the chunk.
+  const DataSet &read_chunk(
+      const dims_t &offset, std::vector<char> &buf,
+      uint32_t *filter_mask = nullptr,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const {
+    buf.resize(get_chunk_storage_size(offset));
+    return read_chunk(offset.data(), buf.data(), filter_mask, xfer_plist);
+  }
+#endif  // H5_VERSION_GE(1, 10, 2)
+
+  /// Get read-only view of the dataset data.
+  ///
+  /// If the dataset has contiguous layout, its storage is allocated, and its
+  /// datatype is the native type associated to T, the view maps the raw data
+  /// in the file into memory, avoiding any copies. Otherwise, the whole
+  /// dataset is read into a buffer owned by the view. T must be trivially
+  /// copyable, since mapped elements are raw file bytes.
+  ///
+  /// Defined in MappedArray.h.
+  template <typename T>
+  MappedArray<T> map() const;
+
   /// Get copy of dataset creation property list.
   PropList::DSetCreat get_create_plist() const {
+    LibraryLock lock;
     hid_t id = H5Dget_create_plist(get_id());
     if (id < 0) throw Exception("DataSet::get_create_plist");
     return id;
   }
+
+  /// Get copy of dataset access property list.
+  PropList::DSetAcc get_access_plist() const {
+    LibraryLock lock;
+    hid_t id = H5Dget_access_plist(get_id());
+    if (id < 0) throw Exception("DataSet::get_access_plist");
+    // The PropList constructor makes its own copy of the list.
+    PropList::DSetAcc plist(id);
+    H5Pclose(id);
+    return plist;
+  }
+
+ private:
+  /// Current extent of a dataset that records are appended to.
+  dims_t _append_extent() const {
+    dims_t dims = get_dataspace().size();
+    if (dims.empty())
+      throw Exception("DataSet::append", "Cannot append to scalar dataset.");
+    return dims;
+  }
+
+  /// Append records to a dataset of current extent `dims`.
+  DataSet &_append(const void *buf, const DataType &mem_type,
+                   hsize_t nrecords, dims_t dims,
+                   const PropList::DSetXfer &xfer_plist) {
+    // Start and count of the new records.
+    dims_t start(dims.size(), 0), count(dims);
+    start[0] = dims[0];
+    count[0] = nrecords;
+
+    dims[0] += nrecords;
+    if (LibraryLock::call(H5Dset_extent, get_id(), dims.data()) < 0)
+      throw Exception("DataSet::append", "Error extending dataset.");
+    ObjectIndex::mark_modified(get_id());
+
+    // The file dataspace is created from the new extent, which avoids a
+    // second H5Dget_space call.
+    DataSpace file_space(dims);
+    file_space.select_hyperslab(H5S_SELECT_SET, count.data(), start.data());
+    return write(buf, mem_type, DataSpace(count), file_space, xfer_plist);
+  }
+};
+
+}  // namespace HDF5
+
+namespace HDF5 {
+
+/// Describes the write of a single dataset in Group::write_many.
+struct DataSet::WriteRequest {
+  DataSet dset;
+  const void *buf;
+  DataType mem_type;
+  DataSpace mem_space;
+  DataSpace file_space;
+
+  WriteRequest(const DataSet &dset, const void *buf, const DataType &mem_type,
+               const DataSpace &mem_space = DataSpace::ALL(),
+               const DataSpace &file_space = DataSpace::ALL())
+      : dset(dset),
+        buf(buf),
+        mem_type(mem_type),
+        mem_space(mem_space),
+        file_space(file_space) {}
+
+  template <typename T>
+  WriteRequest(const DataSet &dset, const T *buf,
+               const DataSpace &mem_space = DataSpace::ALL(),
+               const DataSpace &file_space = DataSpace::ALL())
+      : WriteRequest(dset, buf, PredType::get<T>(), mem_space, file_space) {}
+
+  template <typename T, typename Alloc>
+  WriteRequest(const DataSet &dset, const std::vector<T, Alloc> &buf,
+               const DataSpace &mem_space = DataSpace::ALL(),
+               const DataSpace &file_space = DataSpace::ALL())
+      : WriteRequest(dset, buf.data(), mem_space, file_space) {}
+};
+
+/// Describes the read of a single dataset in Group::read_many.
+struct DataSet::ReadRequest {
+  DataSet dset;
+  void *buf;
+  DataType mem_type;
+  DataSpace mem_space;
+  DataSpace file_space;
+
+  ReadRequest(const DataSet &dset, void *buf, const DataType &mem_type,
+              const DataSpace &mem_space = DataSpace::ALL(),
+              const DataSpace &file_space = DataSpace::ALL())
+      : dset(dset),
+        buf(buf),
+        mem_type(mem_type),
+        mem_space(mem_space),
+        file_space(file_space) {}
+
+  template <typename T>
+  ReadRequest(const DataSet &dset, T *buf,
+              const DataSpace &mem_space = DataSpace::ALL(),
+              const DataSpace &file_space = DataSpace::ALL())
+      : ReadRequest(dset, buf, PredType::get<T>(), mem_space, file_space) {}
+
+  /// The vector is resized to the number of selected points, as in
+  /// DataSet::read.
+  template <typename T, typename Alloc>
+  ReadRequest(const DataSet &dset, std::vector<T, Alloc> &buf,
+              const DataSpace &mem_space = DataSpace::ALL(),
+              const DataSpace &file_space = DataSpace::ALL())
+      : ReadRequest(dset, _resize(dset, buf, mem_space), mem_space,
+                    file_space) {}
+
+ private:
+  template <typename T, typename Alloc>
+  static T *_resize(const DataSet &dset, std::vector<T, Alloc> &buf,
+                    const DataSpace &mem_space) {
+    if (mem_space.get_id() == DataSpace::ALL().get_id())
+      buf.resize(dset.get_dataspace().get_select_npoints());
+    else
+      buf.resize(mem_space.get_select_npoints());
+    return buf.data();
+  }
 };
 
 }  // namespace HDF5
@@ -147,6 +585,244 @@ class DataSet : public Object, public AbstractDataSet {
 // Function implementation.
 namespace HDF5 {
 
+template <typename T, typename Alloc>
+inline std::future<void> DataSet::write_async(
+    std::vector<T, Alloc> buf, const DataSpace &mem_space,
+    const DataSpace &file_space, const PropList::DSetXfer &xfer_plist) {
+#if defined(HDF5MM_USE_EVENT_SETS)
+  using Buffer = std::vector<T, Alloc>;
+  LibraryLock lock;
+  hid_t es_id = H5EScreate();
+  if (es_id < 0) throw Exception("DataSet::write_async", "H5EScreate failed.");
+  // The buffer must live until the operation is complete.
+  auto data = std::make_shared<Buffer>(std::move(buf));
+  if (H5Dwrite_async(get_id(), PredType::get<T>().get_id(), mem_space.get_id(),
+                     file_space.get_id(), xfer_plist.get_id(), data->data(),
+                     es_id) < 0) {
+    H5ESclose(es_id);
+    throw Exception("DataSet::write_async");
+  }
+  // The future of std::async waits in its destructor, so that the event set
+  // is always waited for and closed, and the buffer released afterwards.
+  DataSet dset(*this);
+  return std::async(std::launch::async, [es_id, data, dset]() {
+    LibraryLock lock;
+    size_t num_in_progress;
+    hbool_t err_occurred;
+    herr_t status = H5ESwait(es_id, H5ES_WAIT_FOREVER, &num_in_progress,
+                             &err_occurred);
+    H5ESclose(es_id);
+    if (status < 0 || err_occurred)
+      throw Exception("DataSet::write_async", "Asynchronous write failed.");
+  });
+#else
+  if (LibraryLock::thread_safe()) {
+    using Buffer = std::vector<T, Alloc>;
+    // Note that the task receives its own handles to all HDF5 objects.
+    auto task = [](DataSet dset, Buffer data, DataSpace mspace,
+                   DataSpace fspace, PropList::DSetXfer xfer) {
+      dset.write(data, mspace, fspace, xfer);
+    };
+    return std::async(std::launch::async, task, DataSet(*this),
+                      std::move(buf), mem_space.copy(), file_space.copy(),
+                      xfer_plist);
+  }
+  std::promise<void> done;
+  try {
+    write(buf, mem_space, file_space, xfer_plist);
+    done.set_value();
+  } catch (...) {
+    done.set_exception(std::current_exception());
+  }
+  return done.get_future();
+#endif
+}
+
+template <typename T, typename Alloc>
+inline const DataSet &DataSet::read_fields(
+    const std::vector<std::string> &names, std::vector<T, Alloc> &buf,
+    const DataSpace &mem_space, const DataSpace &file_space,
+    const PropList::DSetXfer &xfer_plist) const {
+  DataType mem_type = CompoundType<T>::instance().subset(names);
+  auto &space = (mem_space.get_id() == DataSpace::ALL().get_id())
+                    ? get_dataspace()
+                    : mem_space;
+  buf.resize(space.get_select_npoints());
+  return read(buf.data(), mem_type, mem_space, file_space, xfer_plist);
+}
+
+template <typename T, typename Alloc>
+inline const DataSet &DataSet::read_field(
+    const std::string &name, std::vector<T, Alloc> &buf,
+    const DataSpace &mem_space, const DataSpace &file_space,
+    const PropList::DSetXfer &xfer_plist) const {
+  // Compound type with a single member, with the size of T.
+  DataType mem_type = H5Tcreate(H5T_COMPOUND, sizeof(T));
+  if (!mem_type.is_valid() ||
+      H5Tinsert(mem_type.get_id(), name.c_str(), 0,
+                PredType::get<T>().get_id()) < 0)
+    throw Exception("DataSet::read_field");
+  auto &space = (mem_space.get_id() == DataSpace::ALL().get_id())
+                    ? get_dataspace()
+                    : mem_space;
+  buf.resize(space.get_select_npoints());
+  return read(buf.data(), mem_type, mem_space, file_space, xfer_plist);
+}
+
+template <typename T, typename Alloc>
+inline const DataSet &DataSet::gather(
+    const std::vector<hsize_t> &indices, std::vector<T, Alloc> &out,
+    const PropList::DSetXfer &xfer_plist) const {
+  auto file_space = get_dataspace();
+  const dims_t dims = file_space.size();
+  if (dims.empty())
+    throw Exception("DataSet::gather", "Dataset must not be scalar.");
+  size_t row = 1;
+  for (size_t d = 1; d < dims.size(); ++d) row *= dims[d];
+
+  // Sorted unique indices, and position of each requested index in them.
+  const bool in_order =
+      std::adjacent_find(indices.begin(), indices.end(),
+                         std::greater_equal<hsize_t>()) == indices.end();
+  std::vector<hsize_t> sorted;
+  std::vector<size_t> slot;
+  if (!in_order) {
+    std::vector<std::pair<hsize_t, size_t>> order(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) order[i] = {indices[i], i};
+    std::sort(order.begin(), order.end());
+    slot.resize(indices.size());
+    for (auto &p : order) {
+      if (sorted.empty() || sorted.back() != p.first) sorted.push_back(p.first);
+      slot[p.second] = sorted.size() - 1;
+    }
+  }
+  const std::vector<hsize_t> &idx = in_order ? indices : sorted;
+  if (!idx.empty() && idx.back() >= dims[0])
+    throw Exception("DataSet::gather", "Index out of range.");
+
+  size_t nruns = 0;
+  for (size_t i = 0; i < idx.size(); ++i)
+    if (i == 0 || idx[i] != idx[i - 1] + 1) ++nruns;
+
+  out.resize(indices.size() * row);
+  if (idx.empty() || row == 0) return *this;
+  std::vector<T, Alloc> tmp;
+  if (!in_order) tmp.resize(idx.size() * row);
+  T *dest = in_order ? out.data() : tmp.data();
+
+  const hsize_t npoints = idx.size() * row;
+  if (dims.size() == 1 && 2 * nruns > idx.size()) {
+    // Mostly isolated points: indices are the coordinates.
+    file_space.select_elements(idx.size(), idx.data());
+    read(dest, DataSpace({npoints}), file_space, xfer_plist);
+  } else {
+    // Unions of hyperslabs, read in batches of max_runs runs. Each OR
+    // operation is linear in the number of blocks already selected, so that
+    // small batches keep the cost linear in the number of runs.
+    constexpr size_t max_runs = 32;
+    dims_t start(dims.size(), 0), count(dims);
+    size_t first = 0, batch_runs = 0;  // first index and runs of the batch
+    for (size_t i = 0; i < idx.size();) {
+      if (batch_runs == 0) {
+        file_space.select_none();
+        first = i;
+      }
+      size_t j = i + 1;
+      while (j < idx.size() && idx[j] == idx[j - 1] + 1) ++j;
+      start[0] = idx[i];
+      count[0] = j - i;
+      file_space.select_hyperslab(H5S_SELECT_OR, count.data(), start.data());
+      i = j;
+      if (++batch_runs == max_runs || i == idx.size()) {
+        const hsize_t n = (i - first) * row;
+        read(dest + first * row, DataSpace({n}), file_space, xfer_plist);
+        batch_runs = 0;
+      }
+    }
+  }
+  if (in_order) return *this;
+
+  // Rows were read in sorted order, copy them to their requested positions.
+  for (size_t i = 0; i < indices.size(); ++i)
+    std::copy(tmp.begin() + slot[i] * row, tmp.begin() + (slot[i] + 1) * row,
+              out.begin() + i * row);
+  return *this;
+}
+
+template <typename Alloc>
+inline DataSet &DataSet::write(const std::vector<std::string, Alloc> &buf,
+                               const DataSpace &mem_space,
+                               const DataSpace &file_space,
+                               const PropList::DSetXfer &xfer_plist) {
+  auto dtype = get_datatype();
+  if (H5Tis_variable_str(dtype.get_id()) > 0) {
+    std::vector<const char *> ptrs;
+    ptrs.reserve(buf.size());
+    for (auto &s : buf) ptrs.push_back(s.c_str());
+    return write(ptrs.data(), dtype, mem_space, file_space, xfer_plist);
+  }
+  FixedStrings packed(buf, dtype.get_size());
+  return write(packed.data(), FixedStrings::memory_type(dtype), mem_space,
+               file_space, xfer_plist);
+}
+
+inline DataSet &DataSet::write(const FixedStrings &buf,
+                               const DataSpace &mem_space,
+                               const DataSpace &file_space,
+                               const PropList::DSetXfer &xfer_plist) {
+  auto dtype = get_datatype();
+  if (H5Tis_variable_str(dtype.get_id()) > 0) {
+    // HDF5 doesn't convert between fixed and variable-length strings.
+    std::vector<std::string> v;
+    buf.to_vector(v);
+    return write(v, mem_space, file_space, xfer_plist);
+  }
+  return write(buf.data(), FixedStrings::memory_type(dtype, buf.width()),
+               mem_space, file_space, xfer_plist);
+}
+
+template <typename Alloc>
+inline const DataSet &DataSet::read(std::vector<std::string, Alloc> &buf,
+                                    const DataSpace &mem_space,
+                                    const DataSpace &file_space,
+                                    const PropList::DSetXfer &xfer_plist) const {
+  auto dtype = get_datatype();
+  if (H5Tis_variable_str(dtype.get_id()) > 0) {
+    auto &space = (mem_space.get_id() == DataSpace::ALL().get_id())
+                      ? get_dataspace()
+                      : mem_space;
+    VLenStrings s(space.get_select_npoints(), dtype, xfer_plist.get_id());
+    read(s.data(), dtype, mem_space, file_space, xfer_plist);
+    s.to_vector(buf);
+  } else {
+    FixedStrings s;
+    read(s, mem_space, file_space, xfer_plist);
+    s.to_vector(buf);
+  }
+  return *this;
+}
+
+inline const DataSet &DataSet::read(FixedStrings &buf,
+                                    const DataSpace &mem_space,
+                                    const DataSpace &file_space,
+                                    const PropList::DSetXfer &xfer_plist) const {
+  auto dtype = get_datatype();
+  auto &space = (mem_space.get_id() == DataSpace::ALL().get_id())
+                    ? get_dataspace()
+                    : mem_space;
+  const size_t N = space.get_select_npoints();
+  if (H5Tis_variable_str(dtype.get_id()) > 0) {
+    VLenStrings s(N, dtype, xfer_plist.get_id());
+    read(s.data(), dtype, mem_space, file_space, xfer_plist);
+    buf = s.to_fixed();
+  } else {
+    buf = FixedStrings(dtype.get_size(), N);
+    read(buf.data(), FixedStrings::memory_type(dtype), mem_space, file_space,
+         xfer_plist);
+  }
+  return *this;
+}
+
 inline const DataSet &DataSet::read(std::string &buf,
                                     const DataSpace &mem_space,
                                     const DataSpace &file_space,
@@ -2,6 +2,7 @@
 
 #include "IdComponent.h"
 
+#include <algorithm>
 #include <array>
 #include <initializer_list>
 #include <vector>
@@ -21,11 +22,18 @@ class DataSpace : public IdComponent {
  public:
   /// Default constructor.
   /// Creates scalar dataspace (`H5S_SCALAR`).
-  DataSpace() : IdComponent(H5Screate(H5S_SCALAR)) {}
+  DataSpace() : IdComponent(LibraryLock::call(H5Screate, H5S_SCALAR)) {}
+
+  /// Maximum dimension size for extendable dataspaces (`H5S_UNLIMITED`).
+  static constexpr hsize_t UNLIMITED = H5S_UNLIMITED;
 
   /// Create simple dataspace (`H5S_SIMPLE`).
-  DataSpace(int rank, const hsize_t *dims)
-      : IdComponent(H5Screate_simple(rank, dims, nullptr)) {}
+  ///
+  /// If `maxdims` is given, it sets the maximum size of each dimension (which
+  /// can be `UNLIMITED`). Otherwise, the maximum size is equal to `dims`.
+  DataSpace(int rank, const hsize_t *dims, const hsize_t *maxdims = nullptr)
+      : IdComponent(
+            LibraryLock::call(H5Screate_simple, rank, dims, maxdims)) {}
 
   /// Create simple dataspace.
   DataSpace(const dims_t &dims) : DataSpace(dims.size(), dims.data()) {}
@@ -33,6 +41,16 @@ class DataSpace : public IdComponent {
   template <size_t N>
   DataSpace(const adims_t<N> &dims) : DataSpace(dims.size(), dims.data()) {}
 
+  /// Create extendable simple dataspace with maximum dimensions.
+  /// (e.g. {{0, 3}, {UNLIMITED, 3}} -> 2D dataspace extendable along the
+  /// first dimension).
+  DataSpace(const dims_t &dims, const dims_t &maxdims)
+      : DataSpace(dims.size(), dims.data(), _check_maxdims(dims, maxdims)) {}
+
+  template <size_t N>
+  DataSpace(const adims_t<N> &dims, const adims_t<N> &maxdims)
+      : DataSpace(dims.size(), dims.data(), maxdims.data()) {}
+
   /// Create simple dataspace from initialiser list
   /// (e.g. {42, 4, 5} -> 3D dataspace).
   DataSpace(std::initializer_list<hsize_t> l)
@@ -42,27 +60,42 @@ class DataSpace : public IdComponent {
   DataSpace(hid_t space_id) : IdComponent(space_id) {}
 
   /// Create from dataspace class (`H5S_SCALAR`, `H5S_SIMPLE` or `H5S_NULL`).
-  DataSpace(H5S_class_t type) : DataSpace(H5Screate(type)) {}
+  DataSpace(H5S_class_t type) : DataSpace(LibraryLock::call(H5Screate, type)) {}
 
   /// Try to close DataSpace.
   ~DataSpace() { destruct(); }
 
+  /// Copy and move semantics are those of IdComponent.
+  DataSpace(const DataSpace &) = default;
+  DataSpace &operator=(const DataSpace &) = default;
+  DataSpace(DataSpace &&) = default;
+  DataSpace &operator=(DataSpace &&) = default;
+
   /// Close DataSpace.
   void close() override {
+    LibraryLock lock;
     if (get_type(get_id()) != H5I_DATASPACE) return;
     if (H5Sclose(get_id()) < 0) throw Exception("DataSpace::close");
     invalidate();
   }
 
+  /// Create independent copy of the dataspace, including its selection.
+  DataSpace copy() const {
+    if (get_id() == H5S_ALL) return ALL();
+    hid_t id = LibraryLock::call(H5Scopy, get_id());
+    if (id < 0) throw Exception("DataSpace::copy");
+    return id;
+  }
+
   /// Select the entire dataspace.
   DataSpace &select_all() {
-    H5Sselect_all(get_id());
+    LibraryLock::call(H5Sselect_all, get_id());
     return *this;
   }
 
   /// Resets the selection to include no elements.
   DataSpace &select_none() {
-    H5Sselect_none(get_id());
+    LibraryLock::call(H5Sselect_none, get_id());
     return *this;
   }
 
@@ -83,10 +116,60 @@ class DataSpace : public IdComponent {
     }
   };
 
+  /// Dimensions of a dataspace, stored in a fixed-size array.
+  ///
+  /// Unlike dims_t, creating and copying an Extent doesn't allocate memory.
+  class Extent {
+   public:
+    /// Maximum rank of a dataspace (`H5S_MAX_RANK`).
+    static constexpr int MAX_RANK = H5S_MAX_RANK;
+
+    /// Create empty (zero-dimensional) extent.
+    Extent() : _rank(0) {}
+
+    /// Create extent from array of dimensions.
+    Extent(int rank, const hsize_t *dims) : _rank(rank) {
+      if (rank < 0 || rank > MAX_RANK)
+        throw Exception("DataSpace::Extent", "Invalid rank.");
+      std::copy(dims, dims + rank, _dims);
+    }
+
+    /// Number of dimensions.
+    int ndims() const { return _rank; }
+
+    /// Size along a single dimension (no bounds checking).
+    hsize_t operator[](int i) const { return _dims[i]; }
+
+    const hsize_t *data() const { return _dims; }
+    const hsize_t *begin() const { return _dims; }
+    const hsize_t *end() const { return _dims + _rank; }
+
+    /// Product of dimensions.
+    hsize_t length() const {
+      hsize_t N = 1;
+      for (auto n : *this) N *= n;
+      return N;
+    }
+
+    /// Convert to dims_t.
+    dims_t to_vector() const { return dims_t(begin(), end()); }
+
+    bool operator==(const Extent &x) const {
+      return _rank == x._rank && std::equal(begin(), end(), x.begin());
+    }
+    bool operator!=(const Extent &x) const { return !(*this == x); }
+
+   private:
+    friend class DataSpace;
+    int _rank;
+    hsize_t _dims[MAX_RANK];
+  };
+
   /// Select hyperslab using Hyperslab object.
   template <size_t N>
   DataSpace &select_hyperslab(const Hyperslab<N> &h,
                               H5S_seloper_t op = H5S_SELECT_SET) {
+    LibraryLock lock;
     H5Sselect_hyperslab(get_id(), op, h.start.data(), h.stride.data(),
                         h.count.data(), h.block.data());
     return *this;
@@ -97,39 +180,126 @@ class DataSpace : public IdComponent {
                               const hsize_t *start,
                               const hsize_t *stride = nullptr,
                               const hsize_t *block = nullptr) {
-    H5Sselect_hyperslab(get_id(), op, start, stride, count, block);
+    LibraryLock::call(H5Sselect_hyperslab, get_id(), op, start, stride, count,
+                      block);
     return *this;
   }
 
+  /// Select individual points.
+  ///
+  /// `coords` is a contiguous array of `num_points * rank` coordinates, where
+  /// the coordinates of point `i` are `coords[i * rank]` to
+  /// `coords[i * rank + rank - 1]`. Points are transferred in the given order.
+  /// With `H5S_SELECT_APPEND` or `H5S_SELECT_PREPEND`, points are added to an
+  /// existing point selection. An empty list of points with `H5S_SELECT_SET`
+  /// selects no elements.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5S_SELECT_ELEMENTS>.
+  DataSpace &select_elements(size_t num_points, const hsize_t *coords,
+                             H5S_seloper_t op = H5S_SELECT_SET) {
+    if (num_points == 0) {
+      // HDF5 doesn't accept empty point lists.
+      if (op == H5S_SELECT_SET) select_none();
+      return *this;
+    }
+    if (LibraryLock::call(H5Sselect_elements, get_id(), op, num_points,
+                          coords) < 0)
+      throw Exception("DataSpace::select_elements");
+    return *this;
+  }
+
+  /// Select points from a contiguous array of coordinates.
+  /// The number of points is the length of `coords` divided by the rank.
+  DataSpace &select_elements(const std::vector<hsize_t> &coords,
+                             H5S_seloper_t op = H5S_SELECT_SET) {
+    const size_t rank = ndims();
+    if (rank == 0 || coords.size() % rank != 0)
+      throw Exception("DataSpace::select_elements",
+                      "Number of coordinates must be a multiple of the rank.");
+    return select_elements(coords.size() / rank, coords.data(), op);
+  }
+
+  /// Select points given as an array of N-dimensional coordinates.
+  template <size_t N>
+  DataSpace &select_elements(const std::vector<adims_t<N>> &points,
+                             H5S_seloper_t op = H5S_SELECT_SET) {
+    static_assert(sizeof(adims_t<N>) == N * sizeof(hsize_t),
+                  "Coordinates must be contiguous.");
+    if (ndims() != int(N))
+      throw Exception("DataSpace::select_elements",
+                      "Points must have the same rank as the dataspace.");
+    return select_elements(points.size(),
+                           reinterpret_cast<const hsize_t *>(points.data()),
+                           op);
+  }
+
   /// Returns the number of elements in the current selection.
   hssize_t get_select_npoints() const {
-    auto N = H5Sget_select_npoints(get_id());
+    auto N = LibraryLock::call(H5Sget_select_npoints, get_id());
     if (N < 0) throw Exception("DataSpace::get_select_npoints");
     return N;
   }
 
+  /// Returns snapshot of the dimensions of the dataspace.
+  ///
+  /// The dimensions are retrieved with a single call to HDF5, without heap
+  /// allocations. The snapshot is not updated if the extent of the dataspace
+  /// is changed later.
+  Extent extent() const {
+    Extent e;
+    int rank = LibraryLock::call(H5Sget_simple_extent_dims, get_id(), e._dims,
+                                 nullptr);
+    if (rank < 0) throw Exception("DataSpace::extent");
+    e._rank = rank;
+    return e;
+  }
+
+  /// Change the dimensions of the dataspace.
+  /// If `maxdims` is null, the maximum dimensions are equal to `dims`.
+  DataSpace &set_extent(int rank, const hsize_t *dims,
+                        const hsize_t *maxdims = nullptr) {
+    if (LibraryLock::call(H5Sset_extent_simple, get_id(), rank, dims,
+                          maxdims) < 0)
+      throw Exception("DataSpace::set_extent");
+    return *this;
+  }
+
+  DataSpace &set_extent(const dims_t &dims) {
+    return set_extent(dims.size(), dims.data());
+  }
+
   /// Returns number of dimensions of the dataspace (like Julia's `ndims`).
-  int ndims() const { return H5Sget_simple_extent_ndims(get_id()); }
+  int ndims() const {
+    return LibraryLock::call(H5Sget_simple_extent_ndims, get_id());
+  }
 
   /// Returns dimensions of the dataspace (like Julia's `size`).
-  dims_t size() const {
-    dims_t dims(ndims());
-    H5Sget_simple_extent_dims(get_id(), dims.data(), nullptr);
-    return dims;
+  dims_t size() const { return extent().to_vector(); }
+
+  /// Returns maximum dimensions of the dataspace.
+  /// Unlimited dimensions are equal to `UNLIMITED`.
+  dims_t max_size() const {
+    dims_t maxdims(ndims());
+    LibraryLock::call(H5Sget_simple_extent_dims, get_id(), nullptr,
+                      maxdims.data());
+    return maxdims;
   }
 
   /// Returns size of the dataspace along a single dimension.
   hsize_t size(int i) const {
-    if (i < 0 || i >= ndims())
-      throw Exception("DataSet::size(int)", "Invalid dimension index.");
-    return size()[i];
+    const Extent e = extent();
+    if (i < 0 || i >= e.ndims())
+      throw Exception("DataSpace::size(int)", "Invalid dimension index.");
+    return e[i];
   }
 
   /// Returns size of the dataspace along a single dimension.
   hsize_t operator[](int i) const { return size(i); }
 
   /// Returns number of elements of the dataspace (like Julia's `length`).
-  hssize_t length() const { return H5Sget_simple_extent_npoints(get_id()); }
+  hssize_t length() const {
+    return LibraryLock::call(H5Sget_simple_extent_npoints, get_id());
+  }
 
   /// DataSpace describing the selection of a complete dataspace.
   static const DataSpace &ALL() {
@@ -143,11 +313,21 @@ class DataSpace : public IdComponent {
     return DataSpace();  // scalar dataspace
   }
 
-  template <typename T>
-  static DataSpace from(const std::vector<T> &x) {
+  template <typename T, typename Alloc>
+  static DataSpace from(const std::vector<T, Alloc> &x) {
     hsize_t N = x.size();
     return DataSpace(1, &N);  // 1D simple dataspace
   }
+
+ private:
+  /// Check that dims and maxdims have the same length.
+  static const hsize_t *_check_maxdims(const dims_t &dims,
+                                       const dims_t &maxdims) {
+    if (dims.size() != maxdims.size())
+      throw Exception("DataSpace::DataSpace",
+                      "Size of dims and maxdims must be equal.");
+    return maxdims.data();
+  }
 };
 
 }  // namespace HDF5
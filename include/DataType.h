@@ -13,19 +13,28 @@ class DataType : public Object {
   /// Try to close datatype.
   virtual ~DataType() { destruct(); }
 
+  /// Copy and move semantics are those of IdComponent.
+  DataType(const DataType &) = default;
+  DataType &operator=(const DataType &) = default;
+  DataType(DataType &&) = default;
+  DataType &operator=(DataType &&) = default;
+
   /// Close datatype.
   virtual void close() override {
+    LibraryLock lock;
     if (get_type(get_id()) != H5I_DATATYPE) return;
     if (H5Tclose(get_id()) < 0) throw Exception("DataType::close");
     invalidate();
   }
 
   /// Get size of datatype in bytes.
-  std::size_t get_size() const { return H5Tget_size(get_id()); }
+  std::size_t get_size() const {
+    return LibraryLock::call(H5Tget_size, get_id());
+  }
 
   /// Compare to another datatype.
   bool operator==(const DataType &type) const {
-    return H5Tequal(get_id(), type.get_id());
+    return LibraryLock::call(H5Tequal, get_id(), type.get_id());
   }
   bool operator!=(const DataType &type) const { return !(*this == type); }
 };
@@ -64,8 +73,8 @@ class PredType : public DataType {
   }
 
   /// Get reference to a datatype from a std::vector instance.
-  template <typename T>
-  static const PredType &from(const std::vector<T> &) {
+  template <typename T, typename Alloc>
+  static const PredType &from(const std::vector<T, Alloc> &) {
     return get<T>();
   }
 
@@ -81,17 +90,18 @@ class PredType : public DataType {
 namespace HDF5 {
 
 /// Associates a HDF5 native type to a C type.
-#define DEFINE_NATIVE_TYPE(htype, ctype)               \
-  inline const PredType &PredType::NATIVE_##htype() {  \
-    static PredType type(H5Tcopy(H5T_NATIVE_##htype)); \
-    return type;                                       \
-  }                                                    \
-                                                       \
-  template <>                                          \
-  inline const PredType &PredType::get<ctype>() {      \
-    return NATIVE_##htype();                           \
-  }                                                    \
-                                                       \
+#define DEFINE_NATIVE_TYPE(htype, ctype)                                  \
+  inline const PredType &PredType::NATIVE_##htype() {                     \
+    static PredType type(                                                 \
+        LibraryLock::call([] { return H5Tcopy(H5T_NATIVE_##htype); }));   \
+    return type;                                                          \
+  }                                                                       \
+                                                                          \
+  template <>                                                             \
+  inline const PredType &PredType::get<ctype>() {                         \
+    return NATIVE_##htype();                                              \
+  }                                                                       \
+                                                                          \
   class PredType  // this is just to require a semicolon after the macro
 
 DEFINE_NATIVE_TYPE(CHAR, char);
@@ -107,6 +117,7 @@ DEFINE_NATIVE_TYPE(FLOAT, float);
 #undef DEFINE_NATIVE_TYPE
 
 inline hid_t PredType::_create_vlen_string() {
+  LibraryLock lock;
   hid_t type_id = H5Tcopy(H5T_C_S1);
   H5Tset_size(type_id, H5T_VARIABLE);
   H5Tset_cset(type_id, H5T_CSET_UTF8);
@@ -1,8 +1,16 @@
 #pragma once
 
 #include "Group.h"
+#include "HandleCache.h"
 #include "PropList.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace HDF5 {
 
 class File : public Group {
@@ -36,12 +44,248 @@ class File : public Group {
        const PropList::FileAcc &fapl = PropList::FileAcc::DEFAULT())
       : File(name.c_str(), flags, fapl) {}
 
+  /// Open or create HDF5 file with the given file creation properties.
+  ///
+  /// The creation property list is only used if a new file is created.
+  ///
+  /// Example (paged aggregation with a 4 MiB page buffer):
+  ///
+  ///     PropList::FileCreat fcpl;
+  ///     fcpl.set_file_space_strategy(H5F_FSPACE_STRATEGY_PAGE)
+  ///         .set_file_space_page_size(64 << 10);
+  ///     PropList::FileAcc fapl;
+  ///     fapl.set_page_buffer_size(4 << 20);
+  ///     File file("data.h5", "w", fapl, fcpl);
+  File(const char *name, unsigned flags, const PropList::FileAcc &fapl,
+       const PropList::FileCreat &fcpl)
+      : Group(_open_or_create(name, flags, fapl, fcpl)) {}
+
+  File(const std::string &name, unsigned flags, const PropList::FileAcc &fapl,
+       const PropList::FileCreat &fcpl)
+      : File(name.c_str(), flags, fapl, fcpl) {}
+
+  File(const char *name, const std::string &flags,
+       const PropList::FileAcc &fapl, const PropList::FileCreat &fcpl)
+      : File(name, _str_to_flags(flags), fapl, fcpl) {}
+
+  File(const std::string &name, const std::string &flags,
+       const PropList::FileAcc &fapl, const PropList::FileCreat &fcpl)
+      : File(name.c_str(), flags, fapl, fcpl) {}
+
   ~File() { destruct(); }
 
+  /// Copy and move semantics are those of IdComponent.
+  File(const File &) = default;
+  File &operator=(const File &) = default;
+  File(File &&) = default;
+  File &operator=(File &&) = default;
+
   /// Close file.
+  ///
+  /// If I/O statistics are being recorded and this is the last handle to the
+  /// file, a summary is printed (see IOStats).
   virtual void close() override {
+    LibraryLock lock;
+    // Release cached handles first when closing the last handle to the
+    // file, so that they don't keep the file open. The cache is shared by
+    // copies of this object, which share the file identifier.
+    if (_cache && refcount() == 1) {
+      _cache->datasets.clear();
+      _cache->groups.clear();
+    }
+    _cache.reset();
+    // Errors when saving the index are rethrown after closing the file.
+    std::exception_ptr error;
+    if (_index && _index.use_count() == 1 && refcount() == 1 &&
+        (_index->modified.get() || _index->unsaved) && _is_writable()) {
+      try {
+        _save_index(index_from_file());
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    _index.reset();
+    // The summary is printed after the file is closed, so that errors when
+    // printing it can't leave the file open.
+    std::string stats_file;
+    if (IOStats::enabled() && refcount() == 1) stats_file = _stats_filename();
     if (H5Fclose(get_id()) < 0) throw Exception("File::close");
     invalidate();
+    if (!stats_file.empty()) IOStats::on_file_close(stats_file);
+    if (error) std::rethrow_exception(error);
+  }
+
+  /// Returns I/O statistics recorded so far for objects of this file
+  /// (see IOStats). Statistics are discarded when the file is closed.
+  IOStats::FileRecords io_stats() const { return IOStats::get(filename()); }
+
+#ifdef H5_HAVE_PARALLEL
+  /// Returns transfer statistics reduced over all processes of `comm`.
+  /// This is a collective operation.
+  std::map<std::string, IOStats::ReducedRecord> io_stats(MPI_Comm comm) const {
+    return IOStats::reduce(io_stats(), comm);
+  }
+#endif
+
+  /// Caches of DataSet and Group handles (see enable_handle_cache).
+  struct HandleCaches {
+    HandleCache<DataSet> datasets;
+    HandleCache<Group> groups;
+    explicit HandleCaches(size_t capacity)
+        : datasets(capacity), groups(capacity) {}
+  };
+
+  /// Enable caching of handles returned by File::open_dataset and
+  /// File::open_group.
+  ///
+  /// Repeated opens of the same path (relative to the root group) then return
+  /// a shared handle instead of traversing the path again. At most `capacity`
+  /// datasets and `capacity` groups are kept open, and the least recently used
+  /// ones are closed first. Datasets opened with an access property list
+  /// whose values differ from the default ones are not cached.
+  ///
+  /// The cache is shared by copies of this File object. Cached handles are
+  /// released when the last of the copies is closed, so that they don't keep
+  /// the file open. The cache must be cleared (see handle_cache) if cached
+  /// objects are unlinked or moved.
+  File &enable_handle_cache(size_t capacity = 1024) {
+    _cache = std::make_shared<HandleCaches>(capacity);
+    return *this;
+  }
+
+  /// Close all cached handles and disable caching.
+  File &disable_handle_cache() {
+    _cache.reset();
+    return *this;
+  }
+
+  /// Returns handle caches, or null if caching is disabled.
+  HandleCaches *handle_cache() const { return _cache.get(); }
+
+  /// Open existing dataset (see Group::open_dataset).
+  /// The handle is cached if enable_handle_cache was called.
+  DataSet open_dataset(
+      const std::string &name,
+      const PropList::DSetAcc &dapl = PropList::DSetAcc::DEFAULT()) const {
+    if (!_is_default(dapl)) return Group::open_dataset(name, dapl);
+    if (!_cache) return _open_dataset_indexed(_cache_key(name));
+    return _cache->datasets.get(_cache_key(name), [this](const std::string &p) {
+      return _open_dataset_indexed(p);
+    });
+  }
+
+  DataSet open_dataset(
+      const char *name,
+      const PropList::DSetAcc &dapl = PropList::DSetAcc::DEFAULT()) const {
+    return open_dataset(std::string(name), dapl);
+  }
+
+  /// Open existing group (see Group::open_group).
+  /// The handle is cached if enable_handle_cache was called.
+  Group open_group(const std::string &name) {
+    if (!_cache) return Group::open_group(name);
+    return _cache->groups.get(_cache_key(name), [this](const std::string &p) {
+      return Group::open_group(p);
+    });
+  }
+
+  Group open_group(const char *name) { return open_group(std::string(name)); }
+
+  /// Use the persistent index of the objects of the file.
+  ///
+  /// The index (see ObjectIndex) is stored in the file under
+  /// ObjectIndex::persistent_path(). If it exists, it is loaded; otherwise
+  /// (or if `rebuild` is true) it is built by traversing the file. Then:
+  ///
+  ///  - index() returns the loaded index without traversing the file;
+  ///  - open_dataset opens indexed datasets by address, without traversing
+  ///    their path, until objects are created, unlinked or resized through
+  ///    this library (see ObjectIndex::ModifiedFlag). Datasets are then
+  ///    opened by path, since their stored addresses may be stale;
+  ///  - if the file is writable and was modified in this way, or if the
+  ///    index was built by traversal, the persistent index is rebuilt and
+  ///    saved when the last handle to the file is closed.
+  ///
+  /// The loaded index is not updated while it's in use, and it's not
+  /// updated at all when the file is modified by other programs. In that
+  /// case, it must be rebuilt by calling this function with `rebuild = true`.
+  File &use_persistent_index(bool rebuild = false) {
+    auto index = std::make_shared<PersistentIndex>(get_id());
+    if (rebuild || !_load_index(index->index)) {
+      index->index = index_from_file();
+      index->unsaved = true;
+    }
+    _index = index;
+    return *this;
+  }
+
+  /// Returns true if the persistent index is being used.
+  bool has_persistent_index() const { return bool(_index); }
+
+  /// Index of all objects of the file.
+  ///
+  /// Returns the persistent index if it's being used (see
+  /// use_persistent_index). Otherwise, the file is traversed.
+  ObjectIndex index() const {
+    return _index ? _index->index : index_from_file();
+  }
+
+  /// Build index of all objects by traversing the file (see Group::index).
+  ObjectIndex index_from_file() const { return Group::index(); }
+
+  /// Get copy of file creation property list.
+  PropList::FileCreat get_create_plist() const {
+    LibraryLock lock;
+    hid_t id = H5Fget_create_plist(get_id());
+    if (id < 0) throw Exception("File::get_create_plist");
+    // The PropList constructor makes its own copy of the list.
+    PropList::FileCreat plist(id);
+    H5Pclose(id);
+    return plist;
+  }
+
+  /// Returns copy of the file image, that is, the contents of the file as
+  /// they would be written to disk.
+  ///
+  /// The image can be sent elsewhere and opened with from_image, without
+  /// going through the file system.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5F_GET_FILE_IMAGE>.
+  std::vector<char> get_image() const {
+    LibraryLock lock;
+    ssize_t size = H5Fget_file_image(get_id(), nullptr, 0);
+    if (size < 0) throw Exception("File::get_image");
+    std::vector<char> image(size);
+    if (H5Fget_file_image(get_id(), image.data(), image.size()) != size)
+      throw Exception("File::get_image");
+    return image;
+  }
+
+  /// Open file from an image in memory (see get_image).
+  ///
+  /// The file is opened with the core driver and the image is copied, so the
+  /// buffer can be released afterwards. If the file is opened in read-write
+  /// mode, modifications are only done in memory, and can be retrieved with
+  /// get_image.
+  ///
+  /// `flags` is either `H5F_ACC_RDONLY` or `H5F_ACC_RDWR`. This is similar
+  /// to `H5LTopen_file_image` from the HDF5 high-level library, which is not
+  /// required here.
+  static File from_image(const void *buf, size_t size,
+                         unsigned flags = H5F_ACC_RDONLY) {
+    static std::atomic<unsigned long> count(0);
+    PropList::FileAcc fapl;
+    fapl.set_fapl_core(std::max<size_t>(size, 1 << 16), false)
+        .set_file_image(buf, size);
+    // Each image gets a unique name, since HDF5 doesn't allow opening the
+    // same file twice with different access properties.
+    std::string name = "file_image_" + std::to_string(count++);
+    return _open_or_create(name.c_str(), flags, fapl);
+  }
+
+  static File from_image(const std::vector<char> &image,
+                         unsigned flags = H5F_ACC_RDONLY) {
+    return from_image(image.data(), image.size(), flags);
   }
 
   /// Determine whether a file exists and is a HDF5 file.
@@ -80,13 +324,73 @@ class File : public Group {
 #endif
 
  private:
+  /// Cached handles, shared by copies of this object.
+  std::shared_ptr<HandleCaches> _cache;
+
+  /// Persistent index, whether the file was modified since it was loaded
+  /// and whether it differs from the saved one, shared by copies of this
+  /// object.
+  struct PersistentIndex {
+    ObjectIndex index;
+    ObjectIndex::ModifiedFlag modified;
+    bool unsaved = false;
+    explicit PersistentIndex(hid_t file_id) : modified(file_id) {}
+  };
+  std::shared_ptr<PersistentIndex> _index;
+
+  /// File name under which I/O statistics are recorded, or an empty string
+  /// if it can't be retrieved.
+  std::string _stats_filename() const {
+    try {
+      return filename();
+    } catch (const Exception &) {
+      return std::string();
+    }
+  }
+
+  bool _is_writable() const {
+    unsigned intent;
+    return H5Fget_intent(get_id(), &intent) >= 0 && (intent & H5F_ACC_RDWR);
+  }
+
+  /// Open dataset by address if it's in the persistent index.
+  DataSet _open_dataset_indexed(const std::string &key) const;
+
+  /// Load persistent index. Returns false if there is no valid index.
+  bool _load_index(ObjectIndex &index) const;
+
+  /// Write persistent index.
+  void _save_index(const ObjectIndex &index);
+
+  /// Returns true if the index stored in group `g` has the current format.
+  static bool _has_index_format(const Group &g) {
+    return g.has_attribute("format_version") &&
+           g.read_attribute<int>("format_version") ==
+               ObjectIndex::format_version();
+  }
+
+  /// Returns true if a dataset access property list has the default values.
+  static bool _is_default(const PropList::DSetAcc &dapl) {
+    const auto &def = PropList::DSetAcc::DEFAULT();
+    return &dapl == &def ||
+           LibraryLock::call(H5Pequal, dapl.get_id(), def.get_id()) > 0;
+  }
+
+  /// Paths are relative to the root group ("/a/b" and "a/b" are equivalent).
+  static std::string _cache_key(const std::string &name) {
+    size_t n = name.find_first_not_of('/');
+    return n == name.npos ? "/" : name.substr(n);
+  }
+
   /// Open or create HDF5 file, according to the given flags.
   /// Returns id of file object.
-  static hid_t _open_or_create(const char *name, unsigned flags,
-                               const PropList::FileAcc &fapl) {
+  static hid_t _open_or_create(
+      const char *name, unsigned flags, const PropList::FileAcc &fapl,
+      const PropList::FileCreat &fcpl = PropList::FileCreat::DEFAULT()) {
+    LibraryLock lock;
     hid_t id;
     if (flags & (H5F_ACC_TRUNC | H5F_ACC_EXCL | H5F_ACC_CREAT)) {
-      id = H5Fcreate(name, flags, H5P_DEFAULT, fapl.get_id());
+      id = H5Fcreate(name, flags, fcpl.get_id(), fapl.get_id());
       if (id < 0)
         throw Exception("File::_open_or_create", "Error creating new file.");
     } else {
@@ -110,6 +414,82 @@ class File : public Group {
   }
 };
 
+}  // namespace HDF5
+
+HDF5MM_COMPOUND_TYPE(HDF5::ObjectIndex::Record, type, ndims, type_class,
+                     layout, type_size, dims_offset, address);
+
+namespace HDF5 {
+
+inline DataSet File::_open_dataset_indexed(const std::string &key) const {
+  // Addresses may be stale once the file has been modified.
+  const ObjectIndex::Entry *e = _index && !_index->modified.get()
+                                    ? _index->index.find("/" + key)
+                                    : nullptr;
+  if (e && e->is_dataset()) {
+    LibraryLock lock;
+#if H5_VERSION_GE(1, 12, 0)
+    hid_t id = H5Oopen_by_token(get_id(), e->address);
+#else
+    hid_t id = H5Oopen_by_addr(get_id(), e->address);
+#endif
+    if (get_type(id) == H5I_DATASET) return id;
+    if (id >= 0) H5Oclose(id);
+  }
+  return Group::open_dataset(key);
+}
+
+inline bool File::_load_index(ObjectIndex &index) const {
+  const char *path = ObjectIndex::persistent_path();
+  if (!exists(path)) return false;
+  Group g = H5Gopen2(get_id(), path, H5P_DEFAULT);
+  if (!g.is_valid() || !_has_index_format(g)) return false;
+  std::vector<std::string> paths;
+  std::vector<ObjectIndex::Record> records;
+  std::vector<uint64_t> dims;
+  g.open_dataset("paths").read(paths);
+  g.open_dataset("records").read(records);
+  g.open_dataset("dims").read(dims);
+  index = ObjectIndex::from_records(get_id(), paths, records, dims);
+  return true;
+}
+
+inline void File::_save_index(const ObjectIndex &index) {
+  std::vector<std::string> paths;
+  std::vector<ObjectIndex::Record> records;
+  std::vector<uint64_t> dims;
+  index.to_records(get_id(), paths, records, dims);
+
+  // Datasets are extendable, so that they can be rewritten in place when the
+  // index is refreshed. An index stored in a different format is replaced.
+  const char *path = ObjectIndex::persistent_path();
+  if (exists(path) && !_has_index_format(Group::open_group(path)))
+    unlink(path);
+  Group g = create_groups(path);
+  auto write = [&g](const char *name, const DataType &type, const void *buf,
+                    hsize_t N) {
+    DataSet dset;
+    if (g.exists(name)) {
+      dset = g.open_dataset(name);
+      dset.set_extent(dims_t{N});
+    } else {
+      PropList::DSetCreat dcpl;
+      dcpl.set_chunk({4096});
+      DataSpace space({N}, {DataSpace::UNLIMITED});
+      dset = g.create_dataset(name, type, space, dcpl);
+    }
+    if (N) dset.write(buf, type);
+  };
+  std::vector<const char *> ptrs;
+  for (auto &p : paths) ptrs.push_back(p.c_str());
+  write("paths", PredType::STRING_UTF8_VLEN(), ptrs.data(), paths.size());
+  write("records", PredType::get<ObjectIndex::Record>(), records.data(),
+        records.size());
+  write("dims", PredType::NATIVE_UINT64(), dims.data(), dims.size());
+  if (!g.has_attribute("format_version"))
+    g.write_attribute(ObjectIndex::format_version(), "format_version");
+}
+
 inline File IdComponent::get_file() const {
   hid_t id = H5Iget_file_id(get_id());
   if (id < 0) throw Exception("IdComponent::get_file");
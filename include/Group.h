@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DataSet.h"
+#include "ObjectIndex.h"
 
 namespace HDF5 {
 
@@ -27,41 +28,65 @@ class Group : public Object {
 
   virtual ~Group() { destruct(); }
 
+  /// Copy and move semantics are those of IdComponent.
+  Group(const Group &) = default;
+  Group &operator=(const Group &) = default;
+  Group(Group &&) = default;
+  Group &operator=(Group &&) = default;
+
   /// Close group.
   virtual void close() override {
+    LibraryLock lock;
     if (get_type(get_id()) != H5I_GROUP) return;
     if (H5Gclose(get_id()) < 0) throw Exception("Group::close");
     invalidate();
   }
 
   /// Create new group under the current object.
-  Group create_group(const char *name) {
-    hid_t id = H5Gcreate2(get_id(), name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  ///
+  /// Missing intermediate groups in `name` are also created if `lcpl` is
+  /// `PropList::LinkCreat::CREATE_PARENTS()`.
+  Group create_group(
+      const char *name,
+      const PropList::LinkCreat &lcpl = PropList::LinkCreat::DEFAULT()) {
+    hid_t id = LibraryLock::call(H5Gcreate2, get_id(), name, lcpl.get_id(),
+                                 H5P_DEFAULT, H5P_DEFAULT);
     if (id < 0) throw Exception("Group::create_group");
+    ObjectIndex::mark_modified(get_id());
     return id;
   }
 
-  Group create_group(const std::string &name) {
-    return create_group(name.c_str());
+  Group create_group(
+      const std::string &name,
+      const PropList::LinkCreat &lcpl = PropList::LinkCreat::DEFAULT()) {
+    return create_group(name.c_str(), lcpl);
   }
 
   /// Recursively create groups in path if they don't exist.
   /// Returns handle to group `name`.
+  ///
+  /// The whole path is created by a single call to `H5Gcreate2` (which
+  /// creates the missing intermediate groups). If the group already exists,
+  /// it is opened instead.
   Group create_groups(const std::string &name) {
     if (name.empty()) return *this;
-    size_t n = name.rfind('/');  // find last occurence of '/'
-
-    // If no '/' was found, create group `name` if it doesn't exist.
-    if (n == name.npos)
-      return exists(name) ? open_group(name) : create_group(name);
-
-    // Recursively create groups before and after the `/`.
-    return create_groups(name.substr(0, n)).create_groups(name.substr(n + 1));
+    LibraryLock lock;
+    hid_t id;
+    // Don't print the HDF5 error stack if the group already exists.
+    H5E_BEGIN_TRY {
+      id = H5Gcreate2(get_id(), name.c_str(),
+                      PropList::LinkCreat::CREATE_PARENTS().get_id(),
+                      H5P_DEFAULT, H5P_DEFAULT);
+    }
+    H5E_END_TRY;
+    if (id < 0) return open_group(name);
+    ObjectIndex::mark_modified(get_id());
+    return id;
   }
 
   /// Open existing group under the current object.
   Group open_group(const char *name) {
-    hid_t id = H5Gopen2(get_id(), name, H5P_DEFAULT);
+    hid_t id = LibraryLock::call(H5Gopen2, get_id(), name, H5P_DEFAULT);
     if (id < 0) throw Exception("Group::open_group");
     return id;
   }
@@ -72,32 +97,78 @@ class Group : public Object {
 
   /// Create new dataset under the current object.
   /// By default, a simple (scalar) dataspace is used.
+  ///
+  /// Missing intermediate groups in `name` are also created if `lcpl` is
+  /// `PropList::LinkCreat::CREATE_PARENTS()`.
   DataSet create_dataset(
       const char *name, const DataType &type,
       const DataSpace &space = DataSpace(),
-      const PropList::DSetCreat &plist = PropList::DSetCreat::DEFAULT()) {
-    hid_t id = H5Dcreate2(get_id(), name, type.get_id(), space.get_id(),
-                          H5P_DEFAULT, plist.get_id(), H5P_DEFAULT);
+      const PropList::DSetCreat &plist = PropList::DSetCreat::DEFAULT(),
+      const PropList::DSetAcc &dapl = PropList::DSetAcc::DEFAULT(),
+      const PropList::LinkCreat &lcpl = PropList::LinkCreat::DEFAULT()) {
+    hid_t id = LibraryLock::call(H5Dcreate2, get_id(), name, type.get_id(),
+                                 space.get_id(), lcpl.get_id(), plist.get_id(),
+                                 dapl.get_id());
     if (id < 0) throw Exception("Group::create_dataset");
+    ObjectIndex::mark_modified(get_id());
     return id;
   }
 
   DataSet create_dataset(
       const std::string &name, const DataType &type,
       const DataSpace &space = DataSpace(),
-      const PropList::DSetCreat &plist = PropList::DSetCreat::DEFAULT()) {
-    return create_dataset(name.c_str(), type, space, plist);
+      const PropList::DSetCreat &plist = PropList::DSetCreat::DEFAULT(),
+      const PropList::DSetAcc &dapl = PropList::DSetAcc::DEFAULT(),
+      const PropList::LinkCreat &lcpl = PropList::LinkCreat::DEFAULT()) {
+    return create_dataset(name.c_str(), type, space, plist, dapl, lcpl);
   }
 
+  /// Create chunked dataset with chunk dimensions chosen for an access
+  /// pattern (see PropList::DSetCreat::guess_chunk).
+  ///
+  /// Unless they are set in the hint, the chunk cache size is taken from
+  /// `dapl` (or from the file access property list), and, if the file uses
+  /// the MPI-IO driver, the dataset is assumed to be decomposed among the
+  /// processes of the file communicator as done by `MPI_Dims_create`. Other
+  /// dataset creation properties (e.g. filters) are taken from `plist`.
+  ///
+  /// Example:
+  ///
+  ///     using Hint = PropList::DSetCreat::AccessHint;
+  ///     auto dset = file.create_dataset("u", PredType::NATIVE_FLOAT(),
+  ///                                     {64, 512, 512}, Hint::planes(0));
+  DataSet create_dataset(
+      const std::string &name, const DataType &type, const DataSpace &space,
+      PropList::DSetCreat::AccessHint hint,
+      PropList::DSetCreat plist = PropList::DSetCreat(),
+      const PropList::DSetAcc &dapl = PropList::DSetAcc::DEFAULT(),
+      const PropList::LinkCreat &lcpl = PropList::LinkCreat::DEFAULT()) {
+    if (!hint.cache_size()) hint.set_cache_size(_chunk_cache_size(dapl));
+#ifdef H5_HAVE_PARALLEL
+    if (hint.decomposition().empty()) _set_decomposition(hint, space.ndims());
+#endif
+    plist.auto_chunk(space.size(), type.get_size(), hint, space.max_size());
+    return create_dataset(name, type, space, plist, dapl, lcpl);
+  }
+
+  /// Build index of all the objects under this group, with a single
+  /// recursive traversal (see ObjectIndex).
+  ObjectIndex index() const { return ObjectIndex::build(get_id()); }
+
   /// Open existing dataset.
-  DataSet open_dataset(const char *name) const {
-    hid_t id = H5Dopen2(get_id(), name, H5P_DEFAULT);
+  /// A dataset access property list may be given (e.g. to set the chunk cache).
+  DataSet open_dataset(
+      const char *name,
+      const PropList::DSetAcc &dapl = PropList::DSetAcc::DEFAULT()) const {
+    hid_t id = LibraryLock::call(H5Dopen2, get_id(), name, dapl.get_id());
     if (id < 0) throw Exception("Group::open_dataset");
     return id;
   }
 
-  DataSet open_dataset(const std::string &name) const {
-    return open_dataset(name.c_str());
+  DataSet open_dataset(
+      const std::string &name,
+      const PropList::DSetAcc &dapl = PropList::DSetAcc::DEFAULT()) const {
+    return open_dataset(name.c_str(), dapl);
   }
 
   /// Create and write dataset (higher-level function).
@@ -126,18 +197,165 @@ class Group : public Object {
     return val;
   }
 
+  /// Write to multiple datasets in a single operation.
+  ///
+  /// With HDF5 >= 1.14, this maps to H5Dwrite_multi, so that in parallel
+  /// builds all the writes are aggregated into a single collective operation.
+  /// With older versions, the datasets are written one after the other. All
+  /// datasets must belong to the same file.
+  ///
+  /// Example:
+  ///
+  ///     g.write_many({{dset_u, u, memspace, filespace},
+  ///                   {dset_v, v, memspace, filespace}}, dxpl);
+  ///
+  void write_many(
+      const std::vector<DataSet::WriteRequest> &requests,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) {
+#if H5_VERSION_GE(1, 14, 0)
+    const size_t count = requests.size();
+    std::vector<hid_t> dset_ids(count), mem_type_ids(count),
+        mem_space_ids(count), file_space_ids(count);
+    std::vector<const void *> bufs(count);
+    for (size_t n = 0; n < count; ++n) {
+      auto &r = requests[n];
+      dset_ids[n] = r.dset.get_id();
+      mem_type_ids[n] = r.mem_type.get_id();
+      mem_space_ids[n] = r.mem_space.get_id();
+      file_space_ids[n] = r.file_space.get_id();
+      bufs[n] = r.buf;
+    }
+    if (count && H5Dwrite_multi(count, dset_ids.data(), mem_type_ids.data(),
+                                mem_space_ids.data(), file_space_ids.data(),
+                                xfer_plist.get_id(), bufs.data()) < 0)
+      throw Exception("Group::write_many");
+#ifdef H5_HAVE_PARALLEL
+    if (IOStats::mpio_enabled())
+      for (auto &r : requests)
+        IOStats::record_mpio(r.dset.get_id(), xfer_plist.get_id());
+#endif
+#else
+    for (auto &r : requests)
+      DataSet(r.dset).write(r.buf, r.mem_type, r.mem_space, r.file_space,
+                            xfer_plist);
+#endif
+  }
+
+  /// Read from multiple datasets in a single operation.
+  /// See write_many for details.
+  void read_many(
+      const std::vector<DataSet::ReadRequest> &requests,
+      const PropList::DSetXfer &xfer_plist = PropList::DSetXfer::DEFAULT()) const {
+#if H5_VERSION_GE(1, 14, 0)
+    const size_t count = requests.size();
+    std::vector<hid_t> dset_ids(count), mem_type_ids(count),
+        mem_space_ids(count), file_space_ids(count);
+    std::vector<void *> bufs(count);
+    for (size_t n = 0; n < count; ++n) {
+      auto &r = requests[n];
+      dset_ids[n] = r.dset.get_id();
+      mem_type_ids[n] = r.mem_type.get_id();
+      mem_space_ids[n] = r.mem_space.get_id();
+      file_space_ids[n] = r.file_space.get_id();
+      bufs[n] = r.buf;
+    }
+    if (count && H5Dread_multi(count, dset_ids.data(), mem_type_ids.data(),
+                               mem_space_ids.data(), file_space_ids.data(),
+                               xfer_plist.get_id(), bufs.data()) < 0)
+      throw Exception("Group::read_many");
+#ifdef H5_HAVE_PARALLEL
+    if (IOStats::mpio_enabled())
+      for (auto &r : requests)
+        IOStats::record_mpio(r.dset.get_id(), xfer_plist.get_id());
+#endif
+#else
+    for (auto &r : requests)
+      r.dset.read(r.buf, r.mem_type, r.mem_space, r.file_space, xfer_plist);
+#endif
+  }
+
   /// Create soft link from this location.
   void create_soft_link(const char *target_path,
                           const char *link_name) {
     if (H5Lcreate_soft(target_path, get_id(), link_name,
                        H5P_LINK_CREATE_DEFAULT, H5P_LINK_ACCESS_DEFAULT) < 0)
       throw Exception("Group::create_soft_link");
+    ObjectIndex::mark_modified(get_id());
   }
 
   void create_soft_link(const std::string &target_path,
                         const std::string &link_name) {
     create_soft_link(target_path.c_str(), link_name.c_str());
   }
+
+  /// Remove link to an object from this location.
+  ///
+  /// The space used by the object is only released once all links to it
+  /// have been removed and it's no longer open.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5L_DELETE>.
+  void unlink(const char *name) {
+    LibraryLock lock;
+    if (H5Ldelete(get_id(), name, H5P_LINK_ACCESS_DEFAULT) < 0)
+      throw Exception("Group::unlink");
+    ObjectIndex::mark_modified(get_id());
+  }
+
+  void unlink(const std::string &name) { unlink(name.c_str()); }
+
+ private:
+  /// Chunk cache size in bytes set in a dataset access property list, or
+  /// else in the file access property list.
+  size_t _chunk_cache_size(const PropList::DSetAcc &dapl) const {
+    LibraryLock lock;
+    size_t nslots, nbytes;
+    double w0;
+    if (H5Pget_chunk_cache(dapl.get_id(), &nslots, &nbytes, &w0) < 0)
+      throw Exception("Group::_chunk_cache_size");
+    if (nbytes != H5D_CHUNK_CACHE_NBYTES_DEFAULT) return nbytes;
+    hid_t fapl_id = _file_access_plist();
+    herr_t status = H5Pget_cache(fapl_id, nullptr, &nslots, &nbytes, &w0);
+    H5Pclose(fapl_id);
+    if (status < 0) throw Exception("Group::_chunk_cache_size");
+    return nbytes;
+  }
+
+  /// Returns copy of the access property list of the file (to be closed by
+  /// the caller).
+  hid_t _file_access_plist() const {
+    hid_t file_id = H5Iget_file_id(get_id());
+    if (file_id < 0) throw Exception("Group::_file_access_plist");
+    hid_t fapl_id = H5Fget_access_plist(file_id);
+    H5Fclose(file_id);
+    if (fapl_id < 0) throw Exception("Group::_file_access_plist");
+    return fapl_id;
+  }
+
+#ifdef H5_HAVE_PARALLEL
+  /// If the file uses the MPI-IO driver, set decomposition of an access hint
+  /// among the processes of the file communicator.
+  void _set_decomposition(PropList::DSetCreat::AccessHint &hint,
+                          int rank) const {
+    LibraryLock lock;
+    hid_t fapl_id = _file_access_plist();
+    MPI_Comm comm;
+    MPI_Info info;
+    if (rank > 0 && H5Pget_driver(fapl_id) == H5FD_MPIO &&
+        H5Pget_fapl_mpio(fapl_id, &comm, &info) >= 0) {
+      int size;
+      MPI_Comm_size(comm, &size);
+      // When appending, records are shared by all processes.
+      std::vector<int> nprocs(rank, 0);
+      if (hint.pattern() == PropList::DSetCreat::AccessHint::APPEND)
+        nprocs[0] = 1;
+      MPI_Dims_create(size, rank, nprocs.data());
+      hint.set_decomposition(dims_t(nprocs.begin(), nprocs.end()));
+      MPI_Comm_free(&comm);
+      if (info != MPI_INFO_NULL) MPI_Info_free(&info);
+    }
+    H5Pclose(fapl_id);
+  }
+#endif  // H5_HAVE_PARALLEL
 };
 
 }  // namespace HDF5
@@ -3,16 +3,30 @@
 #include <hdf5.h>
 
 #include "AbstractDataSet.h"
+#include "Allocator.h"
 #include "Attribute.h"
+#include "AttributeValue.h"
+#include "ChunkedWriter.h"
+#include "CompoundType.h"
 #include "DataSet.h"
 #include "DataSpace.h"
 #include "DataType.h"
 #include "File.h"
 #include "Group.h"
+#include "HandleCache.h"
+#include "IOStats.h"
 #include "IdComponent.h"
+#include "LibraryLock.h"
 #include "Location.h"
+#include "MPIInfo.h"
+#include "MappedArray.h"
 #include "Object.h"
+#include "ObjectIndex.h"
+#include "ParallelReader.h"
 #include "PropList.h"
+#include "SlabIterator.h"
+#include "StaticDataSpace.h"
+#include "Strings.h"
 
 /// Wraps HDF5 C API.
 ///
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Exception.h"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace HDF5 {
+
+/// Bounded cache of open object handles, keyed by path.
+///
+/// Entries are evicted in least-recently-used order when the number of cached
+/// handles exceeds the capacity. Cached handles are shared with the caller
+/// (see IdComponent), so evicting or clearing entries doesn't invalidate the
+/// handles that were returned.
+///
+/// The cache doesn't track changes to the file structure: if an object is
+/// unlinked, moved or replaced, its entry must be removed with erase() or
+/// clear(). This class is not thread-safe.
+///
+/// See File::enable_handle_cache.
+template <class Handle>
+class HandleCache {
+ public:
+  /// Create cache holding at most `capacity` handles.
+  explicit HandleCache(size_t capacity) : _capacity(capacity) {
+    if (capacity == 0)
+      throw Exception("HandleCache::HandleCache", "Capacity must be positive.");
+  }
+
+  /// Returns the handle cached for `path`.
+  /// If `path` is not in the cache, the object is opened by calling
+  /// `open(path)` and the returned handle is cached.
+  template <typename Open>
+  Handle get(const std::string &path, Open &&open) {
+    auto it = _index.find(path);
+    if (it != _index.end()) {
+      ++_hits;
+      _entries.splice(_entries.begin(), _entries, it->second);  // mark as MRU
+      return it->second->second;
+    }
+    ++_misses;
+    Handle h = open(path);
+    _entries.emplace_front(path, h);
+    _index[path] = _entries.begin();
+    if (_entries.size() > _capacity) {
+      _index.erase(_entries.back().first);
+      _entries.pop_back();
+    }
+    return h;
+  }
+
+  /// Remove entry for `path`, if it exists.
+  void erase(const std::string &path) {
+    auto it = _index.find(path);
+    if (it == _index.end()) return;
+    _entries.erase(it->second);
+    _index.erase(it);
+  }
+
+  /// Remove all entries.
+  void clear() {
+    _index.clear();
+    _entries.clear();
+  }
+
+  size_t size() const { return _entries.size(); }
+  size_t capacity() const { return _capacity; }
+
+  /// Number of lookups that were found in the cache.
+  size_t hits() const { return _hits; }
+
+  /// Number of lookups that required opening the object.
+  size_t misses() const { return _misses; }
+
+ private:
+  using Entry = std::pair<std::string, Handle>;
+
+  size_t _capacity;
+  size_t _hits = 0;
+  size_t _misses = 0;
+
+  /// Entries, from most to least recently used.
+  std::list<Entry> _entries;
+  std::unordered_map<std::string, typename std::list<Entry>::iterator> _index;
+};
+
+}  // namespace HDF5
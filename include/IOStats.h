@@ -0,0 +1,479 @@
+#pragma once
+
+#include "Exception.h"
+
+#include <algorithm>  // max
+#include <atomic>
+#include <chrono>
+#include <cstring>  // strlen
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace HDF5 {
+
+/// Opt-in instrumentation of dataset and attribute I/O.
+///
+/// When enabled, DataSet::write and DataSet::read (and, for timing
+/// statistics, Attribute::write and Attribute::read) record statistics about
+/// each transfer. Statistics are aggregated per file and per object name
+/// (attributes are named `object@attribute`), and a summary is printed when
+/// the last handle to a file is closed (see set_output).
+///
+/// Recording is disabled by default. When disabled, the cost of
+/// instrumentation is a single atomic load per transfer. If
+/// HDF5MM_DISABLE_IO_STATS is defined, instrumentation is removed at compile
+/// time.
+///
+/// Statistics are collected independently on each MPI process (see reduce).
+class IOStats {
+ public:
+  /// Clock used for timing transfers.
+  using Clock = std::chrono::steady_clock;
+
+  /// Statistics of transfers in one direction (write or read).
+  struct TransferRecord {
+    /// Number of transfers.
+    size_t ncalls = 0;
+
+    /// Number of bytes transferred, based on the size of the memory datatype.
+    hsize_t bytes = 0;
+
+    /// Total wall time in seconds.
+    double seconds = 0;
+
+    /// Dimensions of the bounding box of the last file selection.
+    std::vector<hsize_t> last_shape;
+  };
+
+#ifdef H5_HAVE_PARALLEL
+  /// Collective I/O statistics of a single dataset.
+  struct MPIORecord {
+    /// Number of instrumented transfers.
+    size_t ncalls = 0;
+
+    /// Number of transfers for each actual I/O mode.
+    std::map<H5D_mpio_actual_io_mode_t, size_t> io_modes;
+
+    /// Number of transfers for each actual chunk optimisation mode.
+    std::map<H5D_mpio_actual_chunk_opt_mode_t, size_t> chunk_opt_modes;
+
+    /// Union of the causes why collective I/O was not performed, on the
+    /// local process and on all processes.
+    uint32_t local_causes = 0;
+    uint32_t global_causes = 0;
+  };
+#endif
+
+  /// Statistics of a single dataset or attribute.
+  struct Record {
+    TransferRecord write;
+    TransferRecord read;
+#ifdef H5_HAVE_PARALLEL
+    MPIORecord mpio;
+#endif
+  };
+
+  /// Statistics of all datasets of a file, indexed by dataset name.
+  using FileRecords = std::map<std::string, Record>;
+
+#ifdef H5_HAVE_PARALLEL
+  /// Enable or disable recording of collective I/O modes.
+  ///
+  /// After each transfer, the actual I/O mode, the actual chunk optimisation
+  /// mode and the causes of falling back to independent I/O are retrieved from
+  /// the transfer property list. Transfers with the default property list
+  /// (which are always independent) are not recorded.
+  static void enable_mpio(bool enable = true) { _state().mpio = enable; }
+
+  static bool mpio_enabled() {
+#ifdef HDF5MM_DISABLE_IO_STATS
+    return false;
+#else
+    return _state().mpio.load(std::memory_order_relaxed);
+#endif
+  }
+#endif
+
+  /// Enable or disable recording of call counts, bytes and wall time.
+  static void enable_timing(bool enable = true) { _state().timing = enable; }
+
+  static bool timing_enabled() {
+#ifdef HDF5MM_DISABLE_IO_STATS
+    return false;
+#else
+    return _state().timing.load(std::memory_order_relaxed);
+#endif
+  }
+
+  /// Returns true if any kind of statistics is being recorded.
+  static bool enabled() {
+#ifdef H5_HAVE_PARALLEL
+    if (mpio_enabled()) return true;
+#endif
+    return timing_enabled();
+  }
+
+  /// Set stream where summaries are printed when closing files.
+  /// If null, summaries are not printed. Default is `std::cerr`.
+  static void set_output(std::ostream *os) {
+    std::lock_guard<std::mutex> lock(_state().mutex);
+    _state().output = os;
+  }
+
+  /// Get copy of the statistics recorded for a file.
+  static FileRecords get(const std::string &filename) {
+    auto &s = _state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.files.find(filename);
+    return it == s.files.end() ? FileRecords() : it->second;
+  }
+
+  /// Discard the statistics recorded for a file.
+  static void clear(const std::string &filename) {
+    auto &s = _state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.files.erase(filename);
+  }
+
+  /// Print summary of the statistics recorded for a file.
+  static void print_summary(const std::string &filename, std::ostream &os);
+
+#ifdef H5_HAVE_PARALLEL
+  /// Minimum, maximum and mean of a quantity over MPI processes.
+  struct Summary {
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+  };
+
+  struct ReducedTransfer {
+    Summary ncalls;
+    Summary bytes;
+    Summary seconds;
+  };
+
+  /// Transfer statistics of an object, reduced over MPI processes.
+  struct ReducedRecord {
+    ReducedTransfer write;
+    ReducedTransfer read;
+  };
+
+  /// Reduce transfer statistics over all processes of a communicator.
+  ///
+  /// This is a collective operation. Objects that are absent on some
+  /// processes are counted as having zero transfers on those processes.
+  static std::map<std::string, ReducedRecord> reduce(
+      const FileRecords &records, MPI_Comm comm);
+#endif
+
+  /// Returns start time of a transfer if `timing` is true (see
+  /// timing_enabled), so that the clock is only read when needed.
+  static Clock::time_point start_timer(bool timing) {
+    return timing ? Clock::now() : Clock::time_point();
+  }
+
+  /// Record a transfer of a dataset or attribute (called by DataSet and
+  /// Attribute). Dataspace ids may be `H5S_ALL`.
+  static void record_transfer(hid_t obj_id, bool is_write, hid_t mem_type_id,
+                              hid_t mem_space_id, hid_t file_space_id,
+                              Clock::time_point start);
+
+#ifdef H5_HAVE_PARALLEL
+  /// Record collective I/O modes of a transfer (called by DataSet).
+  static void record_mpio(hid_t dset_id, hid_t xfer_plist_id);
+#endif
+
+  /// Print summary and discard the statistics of a file (called by File
+  /// after the file is closed).
+  static void on_file_close(const std::string &filename);
+
+ private:
+  struct State {
+    std::mutex mutex;
+    std::map<std::string, FileRecords> files;
+    std::ostream *output = &std::cerr;
+    std::atomic<bool> mpio{false};
+    std::atomic<bool> timing{false};
+  };
+
+  static State &_state() {
+    static State s;
+    return s;
+  }
+
+  /// Calls a `H5?get_name` function on an object id.
+  static std::string _get_name(hid_t id,
+                               ssize_t (*func)(hid_t, char *, size_t)) {
+    ssize_t size = func(id, nullptr, 0);
+    if (size < 0) throw Exception("IOStats::_get_name");
+    std::vector<char> name(size + 1);
+    if (func(id, name.data(), name.size()) < 0)
+      throw Exception("IOStats::_get_name");
+    return std::string(name.data());
+  }
+
+  /// Returns name of an attribute (H5Aget_name has a different signature).
+  static std::string _attr_name(hid_t attr_id) {
+    return _get_name(attr_id, [](hid_t id, char *buf, size_t size) {
+      return H5Aget_name(id, size, buf);
+    });
+  }
+
+  static void _print_transfer(std::ostream &os, const char *what,
+                              const TransferRecord &t) {
+    if (t.ncalls == 0) return;
+    os << "    " << what << ": " << t.ncalls << " calls, " << t.bytes
+       << " bytes, " << t.seconds << " s";
+    if (t.seconds > 0)
+      os << " (" << t.bytes / t.seconds / (1 << 20) << " MiB/s)";
+    if (!t.last_shape.empty()) {
+      os << ", last selection [";
+      for (size_t i = 0; i < t.last_shape.size(); ++i)
+        os << (i ? " x " : "") << t.last_shape[i];
+      os << "]";
+    }
+    os << "\n";
+  }
+
+#ifdef H5_HAVE_PARALLEL
+  static const char *_io_mode_name(H5D_mpio_actual_io_mode_t mode) {
+    switch (mode) {
+      case H5D_MPIO_NO_COLLECTIVE: return "no collective";
+      case H5D_MPIO_CHUNK_INDEPENDENT: return "chunk independent";
+      case H5D_MPIO_CHUNK_COLLECTIVE: return "chunk collective";
+      case H5D_MPIO_CHUNK_MIXED: return "chunk mixed";
+      case H5D_MPIO_CONTIGUOUS_COLLECTIVE: return "contiguous collective";
+    }
+    return "unknown";
+  }
+
+  static const char *_chunk_opt_name(H5D_mpio_actual_chunk_opt_mode_t mode) {
+    switch (mode) {
+      case H5D_MPIO_NO_CHUNK_OPTIMIZATION: return "none";
+      case H5D_MPIO_LINK_CHUNK: return "link chunk";
+      case H5D_MPIO_MULTI_CHUNK: return "multi chunk";
+    }
+    return "unknown";
+  }
+
+  /// Write names of no-collective causes in a bit field.
+  static void _print_causes(std::ostream &os, uint32_t causes) {
+    static const std::pair<uint32_t, const char *> names[] = {
+        {H5D_MPIO_SET_INDEPENDENT, "independent I/O requested"},
+        {H5D_MPIO_DATATYPE_CONVERSION, "datatype conversion"},
+        {H5D_MPIO_DATA_TRANSFORMS, "data transforms"},
+        {H5D_MPIO_NOT_SIMPLE_OR_SCALAR_DATASPACES,
+         "dataspace not simple or scalar"},
+        {H5D_MPIO_NOT_CONTIGUOUS_OR_CHUNKED_DATASET,
+         "dataset not contiguous or chunked"},
+    };
+    if (causes == 0) {
+      os << "none";
+      return;
+    }
+    bool first = true;
+    for (auto &p : names) {
+      if (!(causes & p.first)) continue;
+      os << (first ? "" : ", ") << p.second;
+      causes &= ~p.first;
+      first = false;
+    }
+    if (causes) os << (first ? "" : ", ") << "other (0x" << std::hex << causes
+                   << std::dec << ")";
+  }
+#endif  // H5_HAVE_PARALLEL
+};
+
+}  // namespace HDF5
+
+// Function implementation.
+namespace HDF5 {
+
+#ifdef H5_HAVE_PARALLEL
+inline void IOStats::record_mpio(hid_t dset_id, hid_t xfer_plist_id) {
+  if (xfer_plist_id == H5P_DEFAULT) return;
+  MPIORecord r;
+  H5D_mpio_actual_io_mode_t io_mode;
+  H5D_mpio_actual_chunk_opt_mode_t chunk_mode;
+  if (H5Pget_mpio_actual_io_mode(xfer_plist_id, &io_mode) < 0 ||
+      H5Pget_mpio_actual_chunk_opt_mode(xfer_plist_id, &chunk_mode) < 0 ||
+      H5Pget_mpio_no_collective_cause(xfer_plist_id, &r.local_causes,
+                                      &r.global_causes) < 0)
+    throw Exception("IOStats::record_mpio");
+  std::string filename = _get_name(dset_id, &H5Fget_name);
+  std::string dset_name = _get_name(dset_id, &H5Iget_name);
+
+  auto &s = _state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto &m = s.files[filename][dset_name].mpio;
+  m.ncalls++;
+  m.io_modes[io_mode]++;
+  m.chunk_opt_modes[chunk_mode]++;
+  m.local_causes |= r.local_causes;
+  m.global_causes |= r.global_causes;
+}
+#endif  // H5_HAVE_PARALLEL
+
+inline void IOStats::record_transfer(hid_t obj_id, bool is_write,
+                                     hid_t mem_type_id, hid_t mem_space_id,
+                                     hid_t file_space_id,
+                                     Clock::time_point start) {
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  const bool is_attr = H5Iget_type(obj_id) == H5I_ATTR;
+
+  // Dataspace of the object, if the file selection is H5S_ALL.
+  hid_t space_id = file_space_id;
+  if (space_id == H5S_ALL)
+    space_id = is_attr ? H5Aget_space(obj_id) : H5Dget_space(obj_id);
+  hssize_t npoints = H5Sget_select_npoints(
+      mem_space_id == H5S_ALL ? space_id : mem_space_id);
+  std::vector<hsize_t> shape(std::max(H5Sget_simple_extent_ndims(space_id), 0));
+  if (!shape.empty() && npoints > 0) {
+    std::vector<hsize_t> first(shape.size()), last(shape.size());
+    H5Sget_select_bounds(space_id, first.data(), last.data());
+    for (size_t i = 0; i < shape.size(); ++i)
+      shape[i] = last[i] - first[i] + 1;
+  }
+  if (space_id != file_space_id) H5Sclose(space_id);
+  if (npoints < 0) throw Exception("IOStats::record_transfer");
+
+  std::string filename = _get_name(obj_id, &H5Fget_name);
+  std::string name = _get_name(obj_id, &H5Iget_name);
+  if (is_attr) name += "@" + _attr_name(obj_id);
+
+  auto &s = _state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto &r = s.files[filename][name];
+  auto &t = is_write ? r.write : r.read;
+  t.ncalls++;
+  t.bytes += hsize_t(npoints) * H5Tget_size(mem_type_id);
+  t.seconds += seconds;
+  t.last_shape.swap(shape);
+}
+
+#ifdef H5_HAVE_PARALLEL
+inline std::map<std::string, IOStats::ReducedRecord> IOStats::reduce(
+    const FileRecords &records, MPI_Comm comm) {
+  int nprocs;
+  MPI_Comm_size(comm, &nprocs);
+
+  // Gather the union of object names over all processes.
+  std::string local;
+  for (auto &kv : records) {
+    local += kv.first;
+    local += '\0';
+  }
+  int len = local.size();
+  std::vector<int> lens(nprocs), displs(nprocs);
+  MPI_Allgather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, comm);
+  int total = 0;
+  for (int n = 0; n < nprocs; ++n) {
+    displs[n] = total;
+    total += lens[n];
+  }
+  std::vector<char> all(total);
+  MPI_Allgatherv(local.data(), len, MPI_CHAR, all.data(), lens.data(),
+                 displs.data(), MPI_CHAR, comm);
+  std::set<std::string> names;
+  for (int i = 0; i < total; i += std::strlen(all.data() + i) + 1)
+    names.insert(std::string(all.data() + i));
+
+  // Reduce values of ncalls, bytes and seconds, for writes and reads.
+  constexpr int NVALS = 6;
+  std::vector<double> vals(NVALS * names.size(), 0.);
+  {
+    double *v = vals.data();
+    for (auto &name : names) {
+      auto it = records.find(name);
+      if (it != records.end()) {
+        const TransferRecord *t[] = {&it->second.write, &it->second.read};
+        for (int k = 0; k < 2; ++k) {
+          v[3 * k] = t[k]->ncalls;
+          v[3 * k + 1] = t[k]->bytes;
+          v[3 * k + 2] = t[k]->seconds;
+        }
+      }
+      v += NVALS;
+    }
+  }
+  std::vector<double> vmin(vals.size()), vmax(vals.size()), vsum(vals.size());
+  MPI_Allreduce(vals.data(), vmin.data(), vals.size(), MPI_DOUBLE, MPI_MIN,
+                comm);
+  MPI_Allreduce(vals.data(), vmax.data(), vals.size(), MPI_DOUBLE, MPI_MAX,
+                comm);
+  MPI_Allreduce(vals.data(), vsum.data(), vals.size(), MPI_DOUBLE, MPI_SUM,
+                comm);
+
+  std::map<std::string, ReducedRecord> reduced;
+  size_t i = 0;
+  for (auto &name : names) {
+    auto &r = reduced[name];
+    ReducedTransfer *t[] = {&r.write, &r.read};
+    for (int k = 0; k < 2; ++k) {
+      Summary *q[] = {&t[k]->ncalls, &t[k]->bytes, &t[k]->seconds};
+      for (int j = 0; j < 3; ++j, ++i) {
+        q[j]->min = vmin[i];
+        q[j]->max = vmax[i];
+        q[j]->mean = vsum[i] / nprocs;
+      }
+    }
+  }
+  return reduced;
+}
+#endif  // H5_HAVE_PARALLEL
+
+inline void IOStats::print_summary(const std::string &filename,
+                                   std::ostream &os) {
+  auto records = get(filename);
+  if (records.empty()) return;
+  os << "HDF5mm I/O summary for '" << filename << "'";
+#ifdef H5_HAVE_PARALLEL
+  int initialised, rank = 0;
+  MPI_Initialized(&initialised);
+  if (initialised) {
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    os << " (MPI rank " << rank << ")";
+  }
+#endif
+  os << ":\n";
+  for (auto &kv : records) {
+    os << "  " << kv.first << "\n";
+    _print_transfer(os, "write", kv.second.write);
+    _print_transfer(os, "read", kv.second.read);
+#ifdef H5_HAVE_PARALLEL
+    auto &m = kv.second.mpio;
+    if (m.ncalls) {
+      os << "    collective I/O: " << m.ncalls << " transfers\n";
+      os << "      actual I/O mode:";
+      for (auto &p : m.io_modes)
+        os << " " << _io_mode_name(p.first) << " (" << p.second << ")";
+      os << "\n      actual chunk optimisation:";
+      for (auto &p : m.chunk_opt_modes)
+        os << " " << _chunk_opt_name(p.first) << " (" << p.second << ")";
+      os << "\n      no-collective causes (local): ";
+      _print_causes(os, m.local_causes);
+      os << "\n      no-collective causes (global): ";
+      _print_causes(os, m.global_causes);
+      os << "\n";
+    }
+#endif
+  }
+}
+
+inline void IOStats::on_file_close(const std::string &filename) {
+  std::ostream *os;
+  {
+    std::lock_guard<std::mutex> lock(_state().mutex);
+    os = _state().output;
+  }
+  if (os) print_summary(filename, *os);
+  clear(filename);
+}
+
+}  // namespace HDF5
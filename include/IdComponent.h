@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Exception.h"
+#include "LibraryLock.h"
 
 #include <string>
 
@@ -31,6 +32,7 @@ class IdComponent {
 
   /// Copy constructor. Increases reference count.
   IdComponent(const IdComponent &x) : _id(x._id) {
+    LibraryLock lock;
     if (is_valid(_id)) H5Iinc_ref(_id);
   }
 
@@ -40,6 +42,7 @@ class IdComponent {
   /// This effectively closes the object if its count reaches zero.
   IdComponent &operator=(const IdComponent &x) {
     if (x._id == _id) return *this;
+    LibraryLock lock;
     // Decrease reference count before replacing the current id.
     if (is_valid(_id)) H5Idec_ref(_id);
     _id = x._id;
@@ -48,6 +51,28 @@ class IdComponent {
     return *this;
   }
 
+  /// Move constructor.
+  ///
+  /// The identifier is transferred without any library calls, and the
+  /// moved-from object is left with an invalid id (so that it is not closed
+  /// twice).
+  IdComponent(IdComponent &&x) noexcept : _id(x._id) { x._id = INVALID_HID; }
+
+  /// Move assignment from another IdComponent.
+  ///
+  /// As with copy assignment, the reference count of the current id (if valid)
+  /// is decreased before taking ownership of the new id.
+  IdComponent &operator=(IdComponent &&x) noexcept {
+    if (this == &x) return *this;
+    if (_id != INVALID_HID) {
+      LibraryLock lock;
+      if (H5Iis_valid(_id) > 0) H5Idec_ref(_id);
+    }
+    _id = x._id;
+    x._id = INVALID_HID;
+    return *this;
+  }
+
   /// Get object identifier.
   hid_t get_id() const { return _id; }
 
@@ -71,7 +96,7 @@ class IdComponent {
 
  protected:
   /// Get reference count of an object (for debugging).
-  static int refcount(hid_t id) { return H5Iget_ref(id); }
+  static int refcount(hid_t id) { return LibraryLock::call(H5Iget_ref, id); }
 
   /// Should be called by the destructor of derived classes.
   void destruct() noexcept {
@@ -79,6 +104,7 @@ class IdComponent {
     // is_valid(). An invalid identifier may have values other than INVALID_HID.
     if (_id == INVALID_HID) return;
     try {
+      LibraryLock lock;
       close();
     } catch (Exception &e) {
       std::cerr << e.what() << "\n";
@@ -96,11 +122,13 @@ class IdComponent {
   void invalidate() { _id = INVALID_HID; }
 
   /// Returns the HDF5 type of an object.
-  static H5I_type_t get_type(hid_t id) { return H5Iget_type(id); }
+  static H5I_type_t get_type(hid_t id) {
+    return LibraryLock::call(H5Iget_type, id);
+  }
 
   /// Check if an identifier is "valid". Wraps H5Iis_valid.
   static bool is_valid(hid_t id) {
-    htri_t x = H5Iis_valid(id);
+    htri_t x = LibraryLock::call(H5Iis_valid, id);
     if (x < 0) throw Exception("IdComponent::is_valid");
     return x > 0;
   }
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <hdf5.h>
+
+#include <mutex>
+
+// Thread-safety mode.
+//
+// If HDF5MM_THREADSAFE is defined, the wrappers may be used concurrently from
+// multiple threads. When the HDF5 library itself is thread-safe
+// (H5_HAVE_THREADSAFE), nothing else is needed. Otherwise, the wrappers
+// serialise their calls to the library using a single global mutex (see
+// LibraryLock).
+#if defined(HDF5MM_THREADSAFE) && !defined(H5_HAVE_THREADSAFE)
+#define HDF5MM_SERIALIZE_CALLS
+#endif
+
+namespace HDF5 {
+
+/// Scoped lock serialising calls to the HDF5 library.
+///
+/// The lock is only active when HDF5MM_SERIALIZE_CALLS is defined (that is,
+/// in HDF5MM_THREADSAFE mode with a HDF5 library built without thread-safety
+/// support). Otherwise, it does nothing.
+///
+/// The following operations take the lock internally, so that they can be
+/// called from multiple threads:
+///
+/// - copying, assigning and closing handles (IdComponent and derived
+///   classes), including the lazy initialisation of predefined types;
+/// - creating dataspaces and selecting hyperslabs;
+/// - opening, creating and closing groups and datasets, checking whether
+///   links exist, and building object indices (ObjectIndex);
+/// - resizing datasets, and listing, deleting and batch reading or writing
+///   attributes;
+/// - reading and writing datasets and attributes (including direct chunk
+///   I/O), and querying their datatypes, dataspaces and property lists.
+///
+/// Other calls, including direct calls to the HDF5 C API with identifiers
+/// obtained from the wrappers, must hold a LibraryLock if other threads may
+/// use the library at the same time. The lock is recursive.
+///
+/// Note that instances of the wrappers are not protected against concurrent
+/// modification: a single DataSpace should not be modified (for instance by
+/// select_hyperslab) by one thread while being used from another.
+class LibraryLock {
+ public:
+#ifdef HDF5MM_SERIALIZE_CALLS
+  LibraryLock() { mutex().lock(); }
+  ~LibraryLock() { mutex().unlock(); }
+
+  /// Global library mutex.
+  ///
+  /// The mutex is never destroyed, so that handles in static storage can still
+  /// be closed at program exit.
+  static std::recursive_mutex &mutex() {
+    static auto m = new std::recursive_mutex;
+    return *m;
+  }
+#else
+  LibraryLock() {}
+#endif
+
+  LibraryLock(const LibraryLock &) = delete;
+  LibraryLock &operator=(const LibraryLock &) = delete;
+
+  /// Returns true if library calls are serialised by the wrappers.
+  static constexpr bool enabled() {
+#ifdef HDF5MM_SERIALIZE_CALLS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /// Returns true if handles may be shared across threads (see the list of
+  /// operations above).
+  ///
+  /// This is the case if the HDF5 library is thread-safe, or if calls are
+  /// serialised by the wrappers.
+  static constexpr bool thread_safe() {
+#ifdef H5_HAVE_THREADSAFE
+    return true;
+#else
+    return enabled();
+#endif
+  }
+
+  /// Call function with the lock held.
+  ///
+  /// Useful in constructor initialiser lists, e.g.
+  /// `IdComponent(LibraryLock::call(H5Screate, H5S_SCALAR))`.
+  template <typename F, typename... Args>
+  static auto call(F f, Args... args) -> decltype(f(args...)) {
+    LibraryLock lock;
+    return f(args...);
+  }
+};
+
+}  // namespace HDF5
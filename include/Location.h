@@ -20,7 +20,7 @@ class Location : public IdComponent {
     // See <https://portal.hdfgroup.org/display/HDF5/H5L_EXISTS> for details.
     if (std::strlen(path) == 1 && path[0] == '/') return true;
 #endif
-    return H5Lexists(get_id(), path, H5P_DEFAULT) > 0;
+    return LibraryLock::call(H5Lexists, get_id(), path, H5P_DEFAULT) > 0;
   }
 
   bool exists(const std::string &path) const { return exists(path.c_str()); }
@@ -28,6 +28,7 @@ class Location : public IdComponent {
   /// Check if a given path corresponds to a group.
   /// If the path doesn't exist, return false.
   bool is_group(const char *path) const {
+    LibraryLock lock;
     if (!exists(path)) return false;
     // Try to open it as a generic object and check its type.
     hid_t obj_id = H5Oopen(get_id(), path, H5P_DEFAULT);
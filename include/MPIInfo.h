@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Exception.h"
+
+#ifdef H5_HAVE_PARALLEL
+
+#include <string>
+#include <utility>  // swap
+
+namespace HDF5 {
+
+/// Owns an `MPI_Info` object with MPI-IO hints.
+///
+/// The hints are passed to MPI-IO when opening a file through
+/// PropList::FileAcc::set_mpio. Common ROMIO and Lustre hints have typed
+/// setters; any other hint can be set with set(). Unknown hints are ignored
+/// by MPI.
+///
+/// Example:
+///
+///     MPIInfo info;
+///     info.set_cb_nodes(16).set_cb_buffer_size(16 << 20)
+///         .set_striping_factor(32).set_striping_unit(4 << 20);
+///     PropList::FileAcc fapl;
+///     fapl.set_mpio(MPI_COMM_WORLD, info);
+///
+class MPIInfo {
+ public:
+  /// Create empty info object.
+  MPIInfo() {
+    if (MPI_Info_create(&_info) != MPI_SUCCESS)
+      throw Exception("MPIInfo::MPIInfo", "MPI_Info_create failed.");
+  }
+
+  ~MPIInfo() {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized && _info != MPI_INFO_NULL) MPI_Info_free(&_info);
+  }
+
+  MPIInfo(const MPIInfo &x) {
+    if (MPI_Info_dup(x._info, &_info) != MPI_SUCCESS)
+      throw Exception("MPIInfo::MPIInfo", "MPI_Info_dup failed.");
+  }
+
+  MPIInfo &operator=(const MPIInfo &x) {
+    if (this != &x) *this = MPIInfo(x);
+    return *this;
+  }
+
+  MPIInfo(MPIInfo &&x) noexcept : _info(x._info) { x._info = MPI_INFO_NULL; }
+
+  MPIInfo &operator=(MPIInfo &&x) noexcept {
+    std::swap(_info, x._info);
+    return *this;
+  }
+
+  /// Get underlying MPI_Info object.
+  MPI_Info get() const { return _info; }
+
+  /// Set arbitrary hint.
+  MPIInfo &set(const std::string &key, const std::string &value) {
+    if (MPI_Info_set(_info, key.c_str(), value.c_str()) != MPI_SUCCESS)
+      throw Exception("MPIInfo::set", "Error setting hint '" + key + "'.");
+    return *this;
+  }
+
+  /// Number of aggregators used in collective buffering (`cb_nodes`).
+  MPIInfo &set_cb_nodes(int n) { return set("cb_nodes", std::to_string(n)); }
+
+  /// Size in bytes of the collective buffer of each aggregator
+  /// (`cb_buffer_size`).
+  MPIInfo &set_cb_buffer_size(size_t nbytes) {
+    return set("cb_buffer_size", std::to_string(nbytes));
+  }
+
+  /// Collective buffering for reads and writes (`romio_cb_read` and
+  /// `romio_cb_write`). Valid values are "enable", "disable" and "automatic".
+  MPIInfo &set_romio_cb(const std::string &read, const std::string &write) {
+    return set("romio_cb_read", read).set("romio_cb_write", write);
+  }
+
+  /// Data sieving for reads and writes (`romio_ds_read` and
+  /// `romio_ds_write`). Valid values are "enable", "disable" and "automatic".
+  MPIInfo &set_romio_ds(const std::string &read, const std::string &write) {
+    return set("romio_ds_read", read).set("romio_ds_write", write);
+  }
+
+  /// Number of storage targets a new file is striped over
+  /// (`striping_factor`, used e.g. by Lustre).
+  MPIInfo &set_striping_factor(int n) {
+    return set("striping_factor", std::to_string(n));
+  }
+
+  /// Stripe size in bytes of a new file (`striping_unit`).
+  MPIInfo &set_striping_unit(size_t nbytes) {
+    return set("striping_unit", std::to_string(nbytes));
+  }
+
+ private:
+  MPI_Info _info = MPI_INFO_NULL;
+};
+
+}  // namespace HDF5
+
+#endif  // H5_HAVE_PARALLEL
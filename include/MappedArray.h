@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Allocator.h"
+#include "DataSet.h"
+#include "File.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap
+#include <unistd.h>    // close, sysconf
+#define HDF5MM_HAVE_MMAP
+#endif
+
+#include <cstdint>  // uintptr_t
+#include <type_traits>
+
+namespace HDF5 {
+
+/// Read-only view of the data of a DataSet.
+///
+/// Created by DataSet::map(). If possible, the view is backed by a read-only
+/// memory mapping of the raw data in the file, so that no copy is made and
+/// pages are loaded on demand by the operating system. Otherwise, the data is
+/// read into a buffer owned by the view.
+///
+/// The view may be used after the DataSet and the File are closed. However,
+/// modifications to a mapped dataset by HDF5 after the view was created are
+/// not guaranteed to be visible.
+template <typename T>
+class MappedArray {
+ public:
+  /// Create empty view.
+  MappedArray() = default;
+
+  ~MappedArray() { _unmap(); }
+
+  MappedArray(const MappedArray &) = delete;
+  MappedArray &operator=(const MappedArray &) = delete;
+
+  MappedArray(MappedArray &&x) noexcept { *this = std::move(x); }
+
+  MappedArray &operator=(MappedArray &&x) noexcept {
+    if (this == &x) return *this;
+    _unmap();
+    _data = x._data;
+    _size = x._size;
+    _dims = std::move(x._dims);
+    _buffer = std::move(x._buffer);
+    _map_addr = x._map_addr;
+    _map_length = x._map_length;
+    x._data = nullptr;
+    x._size = 0;
+    x._map_addr = nullptr;
+    x._map_length = 0;
+    return *this;
+  }
+
+  /// Returns true if the data is backed by a memory mapping of the file.
+  bool is_mapped() const { return _map_addr != nullptr; }
+
+  /// Pointer to the first element.
+  const T *data() const { return _data; }
+
+  /// Number of elements.
+  size_t size() const { return _size; }
+
+  /// Dimensions of the dataset.
+  const dims_t &dims() const { return _dims; }
+
+  const T &operator[](size_t i) const { return _data[i]; }
+
+  const T *begin() const { return _data; }
+  const T *end() const { return _data + _size; }
+
+ private:
+  friend class DataSet;
+
+  const T *_data = nullptr;
+  size_t _size = 0;
+  dims_t _dims;
+
+  /// Buffer used when the dataset cannot be mapped.
+  default_init_vector<T> _buffer;
+
+  /// Mapped region (page-aligned).
+  void *_map_addr = nullptr;
+  size_t _map_length = 0;
+
+  void _unmap() noexcept {
+#ifdef HDF5MM_HAVE_MMAP
+    if (_map_addr) munmap(_map_addr, _map_length);
+#endif
+    _map_addr = nullptr;
+    _map_length = 0;
+  }
+};
+
+}  // namespace HDF5
+
+// Function implementation.
+namespace HDF5 {
+
+// Note: this is defined here to avoid circular dependency issues.
+template <typename T>
+inline MappedArray<T> DataSet::map() const {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Mapped element type must be trivially copyable.");
+  MappedArray<T> view;
+  view._dims = get_dataspace().size();
+  view._size = get_dataspace().length();
+  if (view._size == 0) return view;
+
+#ifdef HDF5MM_HAVE_MMAP
+  // The raw data can be mapped if it is stored contiguously in a single file
+  // accessed with the default (sec2) driver, and if its datatype doesn't need
+  // to be converted.
+  auto try_map = [&]() -> bool {
+    auto dcpl = get_create_plist();
+    if (dcpl.get_layout() != H5D_CONTIGUOUS) return false;
+    if (H5Pget_nfilters(dcpl.get_id()) != 0) return false;
+    if (H5Pget_external_count(dcpl.get_id()) != 0) return false;
+    if (get_datatype() != PredType::get<T>()) return false;
+
+    File file = get_file();
+    {
+      hid_t fapl = H5Fget_access_plist(file.get_id());
+      if (fapl < 0) return false;
+      hid_t driver = H5Pget_driver(fapl);
+      H5Pclose(fapl);
+      if (driver != H5FD_SEC2) return false;
+    }
+
+    haddr_t offset = H5Dget_offset(get_id());  // undefined if not allocated
+    if (offset == HADDR_UNDEF) return false;
+    if (H5Dget_storage_size(get_id()) < view._size * sizeof(T)) return false;
+
+    // Make sure that raw data written through this file is on disk.
+    unsigned intent;
+    if (H5Fget_intent(file.get_id(), &intent) < 0) return false;
+    if (intent & H5F_ACC_RDWR) file.flush(false);
+
+    int fd = ::open(file.filename().c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t delta = offset % page;
+    const size_t length = delta + view._size * sizeof(T);
+    void *addr =
+        mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, offset - delta);
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    const char *data = static_cast<const char *>(addr) + delta;
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0) {
+      munmap(addr, length);
+      return false;
+    }
+    view._map_addr = addr;
+    view._map_length = length;
+    view._data = reinterpret_cast<const T *>(data);
+    return true;
+  };
+  if (try_map()) return view;
+#endif  // HDF5MM_HAVE_MMAP
+
+  // Fallback: read the data into a buffer.
+  read(view._buffer);
+  view._data = view._buffer.data();
+  return view;
+}
+
+}  // namespace HDF5
@@ -3,11 +3,14 @@
 #include "Location.h"
 #include "DataSpace.h"
 
+#include <map>
+#include <string>
 #include <vector>
 
 namespace HDF5 {
 
 class Attribute;
+class AttributeValue;
 class DataType;
 class Group;
 
@@ -49,6 +52,27 @@ class Object : public Location {
   template <typename T>
   T read_attribute(const std::string &name) const;
 
+  /// Create and write multiple attributes.
+  ///
+  /// Existing attributes with the same names are replaced. Datatypes and the
+  /// scalar dataspace are shared by all the attributes, and existing
+  /// attributes are listed with a single call to `H5Aiterate2`.
+  void write_attributes(const std::map<std::string, AttributeValue> &attrs);
+
+  /// Read all attributes of the object in a single pass (using
+  /// `H5Aiterate2`).
+  ///
+  /// Attributes of types other than integer, floating point and string are
+  /// returned as values of type AttributeValue::NONE.
+  std::map<std::string, AttributeValue> read_all_attributes() const;
+
+  /// Read the given attributes.
+  std::map<std::string, AttributeValue> read_attributes(
+      const std::vector<std::string> &names) const;
+
+  /// Returns names of all attributes of the object (in name order).
+  std::vector<std::string> attribute_names() const;
+
   /// Check if attribute exists.
   bool has_attribute(const std::string &name) const {
     return H5Aexists(get_id(), name.c_str());
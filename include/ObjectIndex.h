@@ -0,0 +1,445 @@
+#pragma once
+
+#include "DataSpace.h"  // dims_t
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace HDF5 {
+
+/// Flat table describing all the objects under a group.
+///
+/// The index is built by Group::index in a single recursive traversal of the
+/// hierarchy (`H5Ovisit`). For each dataset it stores its shape, datatype
+/// class and size, storage layout and chunk dimensions, so that queries such
+/// as "all 3D float datasets" don't require opening any object.
+///
+/// Entries are sorted by path. Dimensions of all datasets are stored in a
+/// single array, and are accessed through dims() and chunk_dims().
+class ObjectIndex {
+ public:
+  /// Address of an object in the file, as used by `H5Oopen_by_token` (HDF5
+  /// 1.12 and later) or `H5Oopen_by_addr`.
+#if H5_VERSION_GE(1, 12, 0)
+  using Address = H5O_token_t;
+#else
+  using Address = haddr_t;
+#endif
+
+  /// Description of a single object.
+  struct Entry {
+    /// Absolute path of the object.
+    std::string path;
+
+    /// Object type (`H5O_TYPE_GROUP`, `H5O_TYPE_DATASET` or
+    /// `H5O_TYPE_NAMED_DATATYPE`).
+    H5O_type_t type = H5O_TYPE_UNKNOWN;
+
+    /// Address of the object in the file.
+    Address address{};
+
+    // The following fields are only meaningful for datasets.
+
+    /// Number of dimensions (-1 if the object is not a dataset).
+    int ndims = -1;
+
+    /// Class and size of the datatype.
+    H5T_class_t type_class = H5T_NO_CLASS;
+    size_t type_size = 0;
+
+    /// Storage layout.
+    H5D_layout_t layout = H5D_LAYOUT_ERROR;
+
+    bool is_group() const { return type == H5O_TYPE_GROUP; }
+    bool is_dataset() const { return type == H5O_TYPE_DATASET; }
+    bool is_chunked() const { return layout == H5D_CHUNKED; }
+
+   private:
+    friend class ObjectIndex;
+    size_t _dims_offset = 0;
+  };
+
+  using const_iterator = std::vector<Entry>::const_iterator;
+
+  /// Path of the persistent index in a file (see File::use_persistent_index).
+  /// Objects under this path are not included in the index.
+  static const char *persistent_path() { return "/.hdf5mm_index"; }
+
+  /// Version of the format of the persistent index.
+  static int format_version() { return 2; }
+
+  /// Record describing an entry in the persistent index.
+  /// Paths and dimensions are stored in separate datasets.
+  ///
+  /// The layout doesn't depend on the HDF5 version: addresses are stored as
+  /// native file addresses (converted from object tokens with HDF5 >= 1.12).
+  struct Record {
+    int32_t type;
+    int32_t ndims;
+    int32_t type_class;
+    int32_t layout;
+    uint64_t type_size;
+    uint64_t dims_offset;
+    uint64_t address;
+  };
+
+  /// Flag recording whether the objects of a file were modified while its
+  /// persistent index is in use (see File::use_persistent_index).
+  ///
+  /// While the flag exists, it is set by Group and DataSet functions that
+  /// create or unlink objects or resize datasets in the file, whichever
+  /// handle they are called from (see mark_modified). Changes done through
+  /// the HDF5 C API or by other processes are not tracked.
+  class ModifiedFlag {
+   public:
+    /// Track modifications of the file containing `loc_id`.
+    explicit ModifiedFlag(hid_t loc_id, bool modified = false)
+        : _modified(modified) {
+      if (!_get_fileno(loc_id, _fileno))
+        throw Exception("ObjectIndex::ModifiedFlag");
+      auto &r = _registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      r.flags.emplace(_fileno, this);
+      r.count++;
+    }
+
+    ~ModifiedFlag() {
+      auto &r = _registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      auto range = r.flags.equal_range(_fileno);
+      for (auto it = range.first; it != range.second; ++it)
+        if (it->second == this) {
+          r.flags.erase(it);
+          break;
+        }
+      r.count--;
+    }
+
+    ModifiedFlag(const ModifiedFlag &) = delete;
+    ModifiedFlag &operator=(const ModifiedFlag &) = delete;
+
+    bool get() const { return _modified; }
+    void set(bool modified = true) { _modified = modified; }
+
+   private:
+    friend class ObjectIndex;
+    unsigned long _fileno;
+    std::atomic<bool> _modified;
+  };
+
+  /// Set the modified flags of the file containing `loc_id` (called after
+  /// modifying the file). This costs a single atomic load if no persistent
+  /// index is in use. If the file can't be determined, all flags are set.
+  static void mark_modified(hid_t loc_id) {
+    auto &r = _registry();
+    if (r.count.load(std::memory_order_relaxed) == 0) return;
+    unsigned long fileno;
+    const bool known = _get_fileno(loc_id, fileno);
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto &kv : r.flags)
+      if (!known || kv.first == fileno) kv.second->set();
+  }
+
+  ObjectIndex() = default;
+
+  /// Build index of all objects under a group (or file).
+  /// Paths are relative to the root group of the file.
+  static ObjectIndex build(hid_t group_id);
+
+  /// Number of objects.
+  size_t size() const { return _entries.size(); }
+  bool empty() const { return _entries.empty(); }
+
+  const Entry &operator[](size_t i) const { return _entries[i]; }
+  const_iterator begin() const { return _entries.begin(); }
+  const_iterator end() const { return _entries.end(); }
+
+  /// Find object by absolute path.
+  /// Returns null if the object is not in the index.
+  const Entry *find(const std::string &path) const {
+    auto it = std::lower_bound(
+        _entries.begin(), _entries.end(), path,
+        [](const Entry &e, const std::string &p) { return e.path < p; });
+    if (it == _entries.end() || it->path != path) return nullptr;
+    return &*it;
+  }
+
+  /// Dimensions of a dataset (empty for other objects).
+  dims_t dims(const Entry &e) const {
+    if (e.ndims <= 0) return dims_t();
+    auto p = _dims.begin() + e._dims_offset;
+    return dims_t(p, p + e.ndims);
+  }
+
+  /// Chunk dimensions of a dataset (empty if not chunked).
+  dims_t chunk_dims(const Entry &e) const {
+    if (!e.is_chunked() || e.ndims <= 0) return dims_t();
+    auto p = _dims.begin() + e._dims_offset + e.ndims;
+    return dims_t(p, p + e.ndims);
+  }
+
+  /// Returns all datasets with the given number of dimensions and datatype
+  /// class (`H5T_NO_CLASS` matches any class).
+  std::vector<const Entry *> datasets(
+      int ndims, H5T_class_t type_class = H5T_NO_CLASS) const {
+    std::vector<const Entry *> found;
+    for (auto &e : _entries)
+      if (e.is_dataset() && e.ndims == ndims &&
+          (type_class == H5T_NO_CLASS || e.type_class == type_class))
+        found.push_back(&e);
+    return found;
+  }
+
+  /// Convert entries to persistent records (see File::use_persistent_index).
+  /// `file_id` is the file where the records are stored.
+  void to_records(hid_t file_id, std::vector<std::string> &paths,
+                  std::vector<Record> &records,
+                  std::vector<uint64_t> &dims) const {
+    paths.clear();
+    records.clear();
+    for (auto &e : _entries) {
+      paths.push_back(e.path);
+      Record r;
+      r.type = e.type;
+      r.ndims = e.ndims;
+      r.type_class = e.type_class;
+      r.layout = e.layout;
+      r.type_size = e.type_size;
+      r.dims_offset = e._dims_offset;
+      r.address = _to_addr(file_id, e.address);
+      records.push_back(r);
+    }
+    dims.assign(_dims.begin(), _dims.end());
+  }
+
+  /// Create index from persistent records.
+  static ObjectIndex from_records(hid_t file_id,
+                                  const std::vector<std::string> &paths,
+                                  const std::vector<Record> &records,
+                                  const std::vector<uint64_t> &dims) {
+    if (paths.size() != records.size())
+      throw Exception("ObjectIndex::from_records", "Inconsistent sizes.");
+    ObjectIndex index;
+    std::vector<hsize_t> d;
+    for (size_t i = 0; i < records.size(); ++i) {
+      auto &r = records[i];
+      Entry e;
+      e.path = paths[i];
+      e.type = H5O_type_t(r.type);
+      e.ndims = r.ndims;
+      e.type_class = H5T_class_t(r.type_class);
+      e.layout = H5D_layout_t(r.layout);
+      e.type_size = r.type_size;
+      e.address = _from_addr(file_id, r.address);
+      size_t n = e.ndims > 0 ? e.ndims * (e.is_chunked() ? 2 : 1) : 0;
+      if (e.ndims > H5S_MAX_RANK || r.dims_offset + n > dims.size())
+        throw Exception("ObjectIndex::from_records", "Invalid record.");
+      d.assign(dims.begin() + r.dims_offset, dims.begin() + r.dims_offset + n);
+      const hsize_t *chunk = d.data() + (n ? e.ndims : 0);
+      index.add(std::move(e), d.data(), chunk);
+    }
+    index.sort();
+    return index;
+  }
+
+  /// Add entry (used when building the index).
+  /// `dims` and `chunk` must have `e.ndims` elements (chunk only if chunked).
+  void add(Entry e, const hsize_t *dims = nullptr,
+           const hsize_t *chunk = nullptr) {
+    e._dims_offset = _dims.size();
+    if (e.ndims > 0 && dims) _dims.insert(_dims.end(), dims, dims + e.ndims);
+    if (e.ndims > 0 && e.is_chunked() && chunk)
+      _dims.insert(_dims.end(), chunk, chunk + e.ndims);
+    _entries.push_back(std::move(e));
+  }
+
+  /// Sort entries by path (required before calling find).
+  void sort() {
+    std::sort(_entries.begin(), _entries.end(),
+              [](const Entry &a, const Entry &b) { return a.path < b.path; });
+  }
+
+ private:
+  std::vector<Entry> _entries;
+  std::vector<hsize_t> _dims;
+
+  /// Fill dataset fields of an entry.
+  static void _describe_dataset(hid_t dset_id, Entry &e, hsize_t *dims,
+                                hsize_t *chunk);
+
+  /// Conversion between object addresses and stored file addresses.
+  static uint64_t _to_addr(hid_t file_id, const Address &address);
+  static Address _from_addr(hid_t file_id, uint64_t addr);
+
+  /// Get number identifying the file containing an object.
+  /// Returns false on failure.
+  static bool _get_fileno(hid_t loc_id, unsigned long &fileno);
+
+  /// Modified flags of the files whose persistent index is in use.
+  struct Registry {
+    std::mutex mutex;
+    std::multimap<unsigned long, ModifiedFlag *> flags;
+    std::atomic<size_t> count{0};
+  };
+
+  static Registry &_registry() {
+    static Registry r;
+    return r;
+  }
+};
+
+}  // namespace HDF5
+
+// Function implementation.
+namespace HDF5 {
+
+#if H5_VERSION_GE(1, 12, 0)
+inline uint64_t ObjectIndex::_to_addr(hid_t file_id, const Address &address) {
+  haddr_t addr;
+  if (H5VLnative_token_to_addr(file_id, address, &addr) < 0)
+    throw Exception("ObjectIndex::_to_addr");
+  return addr;
+}
+
+inline ObjectIndex::Address ObjectIndex::_from_addr(hid_t file_id,
+                                                    uint64_t addr) {
+  Address token;
+  if (H5VLnative_addr_to_token(file_id, addr, &token) < 0)
+    throw Exception("ObjectIndex::_from_addr");
+  return token;
+}
+#else
+inline uint64_t ObjectIndex::_to_addr(hid_t, const Address &address) {
+  return address;
+}
+
+inline ObjectIndex::Address ObjectIndex::_from_addr(hid_t, uint64_t addr) {
+  return addr;
+}
+#endif
+
+inline bool ObjectIndex::_get_fileno(hid_t loc_id, unsigned long &fileno) {
+  LibraryLock lock;
+#if H5_VERSION_GE(1, 12, 0)
+  H5O_info2_t info;
+  herr_t status = H5Oget_info3(loc_id, &info, H5O_INFO_BASIC);
+#elif H5_VERSION_GE(1, 10, 3)
+  H5O_info_t info;
+  herr_t status = H5Oget_info2(loc_id, &info, H5O_INFO_BASIC);
+#else
+  H5O_info_t info;
+  herr_t status = H5Oget_info(loc_id, &info);
+#endif
+  if (status < 0) return false;
+  fileno = info.fileno;
+  return true;
+}
+
+inline void ObjectIndex::_describe_dataset(hid_t dset_id, Entry &e,
+                                           hsize_t *dims, hsize_t *chunk) {
+  hid_t space_id = H5Dget_space(dset_id);
+  e.ndims = H5Sget_simple_extent_dims(space_id, dims, nullptr);
+  H5Sclose(space_id);
+
+  hid_t type_id = H5Dget_type(dset_id);
+  e.type_class = H5Tget_class(type_id);
+  e.type_size = H5Tget_size(type_id);
+  H5Tclose(type_id);
+
+  hid_t dcpl_id = H5Dget_create_plist(dset_id);
+  e.layout = H5Pget_layout(dcpl_id);
+  if (e.layout == H5D_CHUNKED) H5Pget_chunk(dcpl_id, H5S_MAX_RANK, chunk);
+  H5Pclose(dcpl_id);
+
+  if (e.ndims < 0 || e.type_class == H5T_NO_CLASS ||
+      e.layout == H5D_LAYOUT_ERROR)
+    throw Exception("ObjectIndex::_describe_dataset",
+                    "Error describing dataset " + e.path);
+}
+
+inline ObjectIndex ObjectIndex::build(hid_t group_id) {
+  struct Data {
+    ObjectIndex index;
+    std::string prefix;  // path of the visited group, ending with '/'
+    std::exception_ptr error;
+  } data;
+
+  {
+    ssize_t size = H5Iget_name(group_id, nullptr, 0);
+    if (size < 0) throw Exception("ObjectIndex::build");
+    std::vector<char> name(size + 1);
+    H5Iget_name(group_id, name.data(), name.size());
+    data.prefix = name.data();
+    if (data.prefix.empty() || data.prefix.back() != '/') data.prefix += '/';
+  }
+
+#if H5_VERSION_GE(1, 12, 0)
+  using info_t = H5O_info2_t;
+#else
+  using info_t = H5O_info_t;
+#endif
+
+  auto op = [](hid_t obj_id, const char *name, const info_t *info,
+               void *ptr) -> herr_t {
+    auto &d = *static_cast<Data *>(ptr);
+    if (std::strcmp(name, ".") == 0) return 0;  // the visited group itself
+    try {
+      Entry e;
+      e.path = d.prefix + name;
+      // Skip the persistent index.
+      const size_t n = std::strlen(persistent_path());
+      if (e.path.compare(0, n, persistent_path()) == 0 &&
+          (e.path.size() == n || e.path[n] == '/'))
+        return 0;
+      e.type = info->type;
+#if H5_VERSION_GE(1, 12, 0)
+      e.address = info->token;
+#else
+      e.address = info->addr;
+#endif
+      hsize_t dims[H5S_MAX_RANK], chunk[H5S_MAX_RANK];
+      if (e.is_dataset()) {
+        hid_t dset_id = H5Dopen2(obj_id, name, H5P_DEFAULT);
+        if (dset_id < 0)
+          throw Exception("ObjectIndex::build", "Error opening " + e.path);
+        try {
+          _describe_dataset(dset_id, e, dims, chunk);
+        } catch (...) {
+          H5Dclose(dset_id);
+          throw;
+        }
+        H5Dclose(dset_id);
+      }
+      d.index.add(std::move(e), dims, chunk);
+    } catch (...) {
+      // Exceptions can't propagate through the HDF5 library.
+      d.error = std::current_exception();
+      return -1;
+    }
+    return 0;
+  };
+
+  LibraryLock lock;
+#if H5_VERSION_GE(1, 12, 0)
+  herr_t status = H5Ovisit3(group_id, H5_INDEX_NAME, H5_ITER_INC, op, &data,
+                            H5O_INFO_BASIC);
+#elif H5_VERSION_GE(1, 10, 3)
+  herr_t status = H5Ovisit2(group_id, H5_INDEX_NAME, H5_ITER_INC, op, &data,
+                            H5O_INFO_BASIC);
+#else
+  herr_t status = H5Ovisit(group_id, H5_INDEX_NAME, H5_ITER_INC, op, &data);
+#endif
+  if (data.error) std::rethrow_exception(data.error);
+  if (status < 0) throw Exception("ObjectIndex::build");
+  data.index.sort();
+  return std::move(data.index);
+}
+
+}  // namespace HDF5
@@ -0,0 +1,383 @@
+#pragma once
+
+#include "ChunkedWriter.h"  // HDF5MM_HAVE_ZLIB
+#include "DataSet.h"
+#include "LibraryLock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>  // memcpy
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HDF5 {
+
+/// Reads a block of a single dataset using multiple threads.
+///
+/// The block is split into tasks that are processed by a pool of worker
+/// threads. For chunked datasets whose filter pipeline is supported (no
+/// filters, shuffle and/or deflate), each task reads a raw chunk with a direct
+/// chunk read (see DataSet::read_chunk), and then decompresses it and copies
+/// it to the output buffer. Only the raw chunk read is done while holding the
+/// library lock (see LibraryLock), so that decompression runs in parallel.
+///
+/// Otherwise, the block is split into slabs along the first dimension that
+/// are read with regular hyperslab reads. Note that in this case the HDF5
+/// library serialises the reads, including the filter pipeline.
+///
+/// The dataset handle is shared by all the worker threads, which requires
+/// either a thread-safe HDF5 library or HDF5MM_THREADSAFE mode (see
+/// LibraryLock::thread_safe). If neither is available, the constructor throws
+/// an exception.
+///
+/// Example:
+///
+///     auto dset = file.open_dataset("u");
+///     ParallelReader reader(dset, 8);
+///     std::vector<double> u;
+///     reader.read(u);  // full dataset
+///
+class ParallelReader {
+ public:
+  /// Create reader for a dataset.
+  ///
+  /// If `nthreads` is zero, the number of threads is set to the number of
+  /// hardware threads.
+  explicit ParallelReader(const DataSet &dset, unsigned nthreads = 0);
+
+  /// Number of worker threads.
+  unsigned nthreads() const { return _nthreads; }
+
+  /// Returns true if chunks are decompressed by the worker threads (that is,
+  /// if the dataset is chunked and its filters are supported).
+  ///
+  /// Even if this returns true, blocks read with a memory datatype different
+  /// from the dataset datatype go through the HDF5 library.
+  bool decodes_chunks() const { return _decode; }
+
+  /// Read full dataset into std::vector (which is resized).
+  template <typename T, typename Alloc>
+  ParallelReader &read(std::vector<T, Alloc> &buf) {
+    buf.resize(_length(_dims));
+    return read(buf.data(), PredType::get<T>(), dims_t(_dims.size(), 0),
+                _dims);
+  }
+
+  /// Read block of the dataset in row-major order.
+  ///
+  /// The block starts at `start` and has dimensions `count`. The buffer must
+  /// hold the product of `count` elements.
+  template <typename T>
+  ParallelReader &read(T *buf, const dims_t &start, const dims_t &count) {
+    return read(buf, PredType::get<T>(), start, count);
+  }
+
+  /// Read block with the given memory datatype.
+  ParallelReader &read(void *buf, const DataType &mem_type,
+                       const dims_t &start, const dims_t &count);
+
+ private:
+  DataSet _dset;
+  unsigned _nthreads;
+  DataType _type;
+  size_t _type_size;
+
+  /// Dataset and chunk dimensions.
+  dims_t _dims;
+  dims_t _chunk;
+
+  /// Filters of the pipeline, in the order in which they are applied when
+  /// writing.
+  std::vector<H5Z_filter_t> _filters;
+
+  /// Whether chunks are read directly and decoded by the worker threads.
+  bool _decode = false;
+
+  static size_t _length(const dims_t &dims) {
+    size_t N = 1;
+    for (auto n : dims) N *= n;
+    return N;
+  }
+
+  /// Run `num_tasks` tasks on the worker threads.
+  /// The task function is called as `task(k)`, with `0 <= k < num_tasks`.
+  template <typename Task>
+  void _run(size_t num_tasks, Task task) const;
+
+  /// Read block as slabs along the first dimension.
+  void _read_slabs(char *buf, const DataType &mem_type, const dims_t &start,
+                   const dims_t &count) const;
+
+  /// Read block chunk by chunk, decoding chunks on the worker threads.
+  void _read_chunks(char *buf, const dims_t &start, const dims_t &count) const;
+
+  /// Read region of a chunk with a hyperslab read (used for unallocated
+  /// chunks, which are filled with the fill value by HDF5).
+  void _read_region(char *buf, const dims_t &start, const dims_t &count,
+                    const dims_t &lo, const dims_t &hi) const;
+
+  /// Undo the filter pipeline on a raw chunk.
+  void _decode_chunk(std::vector<char> &raw, uint32_t filter_mask,
+                     std::vector<char> &tmp) const;
+
+  /// Inverse of the byte shuffle done by the HDF5 shuffle filter.
+  static void _unshuffle(const std::vector<char> &in, std::vector<char> &out,
+                         size_t type_size) {
+    out.resize(in.size());
+    const size_t N = in.size() / type_size;
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < type_size; ++j)
+        out[i * type_size + j] = in[j * N + i];
+    // Trailing bytes (if any) are left unchanged.
+    std::copy(in.begin() + N * type_size, in.end(),
+              out.begin() + N * type_size);
+  }
+};
+
+}  // namespace HDF5
+
+// Function implementation.
+namespace HDF5 {
+
+inline ParallelReader::ParallelReader(const DataSet &dset, unsigned nthreads)
+    : _dset(dset),
+      _nthreads(nthreads ? nthreads : std::thread::hardware_concurrency()),
+      _type(dset.get_datatype()),
+      _type_size(_type.get_size()),
+      _dims(dset.get_dataspace().size()) {
+  if (!LibraryLock::thread_safe())
+    throw Exception("ParallelReader::ParallelReader",
+                    "The HDF5 library is not thread-safe. Define "
+                    "HDF5MM_THREADSAFE to serialise library calls.");
+  if (_nthreads == 0) _nthreads = 1;
+
+  auto dcpl = dset.get_create_plist();
+  _chunk = dcpl.get_chunk();
+#if H5_VERSION_GE(1, 10, 2)
+  if (_chunk.empty()) return;
+  LibraryLock lock;
+  int nfilters = H5Pget_nfilters(dcpl.get_id());
+  if (nfilters < 0) throw Exception("ParallelReader::ParallelReader");
+  // Variable-length data and references can't be copied from raw chunks.
+  const hid_t type_id = _type.get_id();
+  _decode = H5Tdetect_class(type_id, H5T_VLEN) == 0 &&
+            H5Tis_variable_str(type_id) == 0 &&
+            H5Tdetect_class(type_id, H5T_REFERENCE) == 0;
+  for (int i = 0; i < nfilters; ++i) {
+    unsigned flags, config;
+    size_t nvalues = 0;
+    H5Z_filter_t id = H5Pget_filter2(dcpl.get_id(), i, &flags, &nvalues,
+                                     nullptr, 0, nullptr, &config);
+    _filters.push_back(id);
+    if (id == H5Z_FILTER_SHUFFLE) continue;
+#ifdef HDF5MM_HAVE_ZLIB
+    if (id == H5Z_FILTER_DEFLATE) continue;
+#endif
+    _decode = false;  // unsupported filter
+  }
+#endif  // H5_VERSION_GE(1, 10, 2)
+}
+
+template <typename Task>
+inline void ParallelReader::_run(size_t num_tasks, Task task) const {
+  std::atomic<size_t> next_task(0);
+  std::atomic<bool> abort(false);
+  std::mutex mutex;
+  std::exception_ptr error;
+
+  auto worker = [&]() {
+    while (!abort) {
+      size_t k = next_task++;
+      if (k >= num_tasks) return;
+      try {
+        task(k);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+        abort = true;
+      }
+    }
+  };
+
+  const size_t n = std::min<size_t>(_nthreads, num_tasks);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < n; ++i) threads.emplace_back(worker);
+  worker();  // the calling thread also works
+  for (auto &t : threads) t.join();
+  if (error) std::rethrow_exception(error);
+}
+
+inline ParallelReader &ParallelReader::read(void *buf,
+                                            const DataType &mem_type,
+                                            const dims_t &start,
+                                            const dims_t &count) {
+  const size_t rank = _dims.size();
+  if (start.size() != rank || count.size() != rank)
+    throw Exception("ParallelReader::read",
+                    "Block must have the same rank as the dataset.");
+  for (size_t d = 0; d < rank; ++d)
+    if (start[d] + count[d] > _dims[d])
+      throw Exception("ParallelReader::read",
+                      "Block exceeds the dataset dimensions.");
+  if (_length(count) == 0) return *this;
+  char *out = static_cast<char *>(buf);
+  if (_decode && mem_type == _type)
+    _read_chunks(out, start, count);
+  else
+    _read_slabs(out, mem_type, start, count);
+  return *this;
+}
+
+inline void ParallelReader::_read_slabs(char *buf, const DataType &mem_type,
+                                        const dims_t &start,
+                                        const dims_t &count) const {
+  if (count.empty()) {  // scalar dataset
+    _dset.read(buf, mem_type);
+    return;
+  }
+
+  // Slabs are aligned to chunks along the first dimension (if chunked), and
+  // there are a few slabs per thread to balance the load.
+  const hsize_t n0 = count[0];
+  hsize_t step = (n0 + 4 * _nthreads - 1) / (4 * _nthreads);
+  if (!_chunk.empty())
+    step = std::max<hsize_t>(1, (step + _chunk[0] - 1) / _chunk[0]) * _chunk[0];
+  const size_t row_bytes =
+      _length(dims_t(count.begin() + 1, count.end())) * mem_type.get_size();
+  const size_t num_tasks = (n0 + step - 1) / step;
+
+  _run(num_tasks, [&](size_t k) {
+    dims_t slab_start = start, slab_count = count;
+    slab_start[0] += k * step;
+    slab_count[0] = std::min(step, n0 - k * step);
+    auto fspace = _dset.get_dataspace();
+    fspace.select_hyperslab(H5S_SELECT_SET, slab_count.data(),
+                            slab_start.data());
+    _dset.read(buf + k * step * row_bytes, mem_type, DataSpace(slab_count),
+               fspace);
+  });
+}
+
+inline void ParallelReader::_read_region(char *buf, const dims_t &start,
+                                         const dims_t &count, const dims_t &lo,
+                                         const dims_t &hi) const {
+  const size_t rank = _dims.size();
+  dims_t n(rank), mem_start(rank);
+  for (size_t d = 0; d < rank; ++d) {
+    n[d] = hi[d] - lo[d];
+    mem_start[d] = lo[d] - start[d];
+  }
+  auto fspace = _dset.get_dataspace();
+  fspace.select_hyperslab(H5S_SELECT_SET, n.data(), lo.data());
+  DataSpace mspace(count);
+  mspace.select_hyperslab(H5S_SELECT_SET, n.data(), mem_start.data());
+  _dset.read(buf, _type, mspace, fspace);
+}
+
+inline void ParallelReader::_decode_chunk(std::vector<char> &raw,
+                                          uint32_t filter_mask,
+                                          std::vector<char> &tmp) const {
+  const size_t chunk_bytes = _length(_chunk) * _type_size;
+  // Filters are undone in reverse order. Bit `i` of the filter mask is set if
+  // filter `i` was not applied.
+  for (size_t i = _filters.size(); i-- > 0;) {
+    if (filter_mask & (1u << i)) continue;
+    if (_filters[i] == H5Z_FILTER_SHUFFLE) {
+      _unshuffle(raw, tmp, _type_size);
+      raw.swap(tmp);
+    }
+#ifdef HDF5MM_HAVE_ZLIB
+    else if (_filters[i] == H5Z_FILTER_DEFLATE) {
+      // Apart from the shuffle filter, the size of the data is unchanged.
+      tmp.resize(chunk_bytes);
+      uLongf size = tmp.size();
+      if (uncompress(reinterpret_cast<Bytef *>(tmp.data()), &size,
+                     reinterpret_cast<const Bytef *>(raw.data()),
+                     raw.size()) != Z_OK)
+        throw Exception("ParallelReader::_decode_chunk",
+                        "Decompression failed.");
+      tmp.resize(size);
+      raw.swap(tmp);
+    }
+#endif
+  }
+  if (raw.size() != chunk_bytes)
+    throw Exception("ParallelReader::_decode_chunk",
+                    "Unexpected size of decoded chunk.");
+}
+
+inline void ParallelReader::_read_chunks(char *buf, const dims_t &start,
+                                         const dims_t &count) const {
+#if H5_VERSION_GE(1, 10, 2)
+  const size_t rank = _dims.size();
+
+  // Range of chunk indices intersecting the block.
+  dims_t first(rank), grid(rank);
+  size_t num_tasks = 1;
+  for (size_t d = 0; d < rank; ++d) {
+    first[d] = start[d] / _chunk[d];
+    grid[d] = (start[d] + count[d] - 1) / _chunk[d] - first[d] + 1;
+    num_tasks *= grid[d];
+  }
+
+  _run(num_tasks, [&](size_t k) {
+    // Offset of the chunk, and intersection [lo, hi) with the block.
+    dims_t offset(rank), lo(rank), hi(rank);
+    for (size_t d = rank; d-- > 0;) {
+      offset[d] = (first[d] + k % grid[d]) * _chunk[d];
+      k /= grid[d];
+      lo[d] = std::max(offset[d], start[d]);
+      hi[d] = std::min(offset[d] + _chunk[d], start[d] + count[d]);
+    }
+
+    // Only the raw I/O is done with the library lock held.
+    std::vector<char> raw, tmp;
+    uint32_t mask = 0;
+    {
+      LibraryLock lock;
+      // Fails if the chunk is not allocated (in some HDF5 versions).
+      hsize_t size = 0;
+      herr_t status;
+      H5E_BEGIN_TRY {
+        status = H5Dget_chunk_storage_size(_dset.get_id(), offset.data(),
+                                           &size);
+      }
+      H5E_END_TRY;
+      if (status < 0 || size == 0) {
+        _read_region(buf, start, count, lo, hi);
+        return;
+      }
+      raw.resize(size);
+      _dset.read_chunk(offset.data(), raw.data(), &mask);
+    }
+    _decode_chunk(raw, mask, tmp);
+
+    // Copy intersection to the output, one row (along the last dimension)
+    // at a time.
+    size_t nrows = 1;
+    for (size_t d = 0; d + 1 < rank; ++d) nrows *= hi[d] - lo[d];
+    const size_t row_bytes = (hi[rank - 1] - lo[rank - 1]) * _type_size;
+    dims_t idx(lo);  // index of current row in the dataset
+    for (size_t r = 0; r < nrows; ++r) {
+      size_t src = 0, dst = 0;
+      for (size_t d = 0; d < rank; ++d) {
+        src = src * _chunk[d] + idx[d] - offset[d];
+        dst = dst * count[d] + idx[d] - start[d];
+      }
+      std::memcpy(buf + dst * _type_size, raw.data() + src * _type_size,
+                  row_bytes);
+      // Increment row index (the last dimension is fixed).
+      for (size_t d = rank - 1; d-- > 0;) {
+        if (++idx[d] < hi[d]) break;
+        idx[d] = lo[d];
+      }
+    }
+  });
+#else
+  _read_slabs(buf, _type, start, count);
+#endif  // H5_VERSION_GE(1, 10, 2)
+}
+
+}  // namespace HDF5
@@ -2,6 +2,9 @@
 
 #include "DataSpace.h"  // dims_t
 #include "IdComponent.h"
+#include "MPIInfo.h"
+
+#include <algorithm>
 
 namespace HDF5 {
 
@@ -14,12 +17,20 @@ class PropList : public IdComponent {
   PropList() = delete;
 
   /// Copy existing property list using its id.
-  PropList(hid_t plist_id) : IdComponent(H5Pcopy(plist_id)) {}
+  PropList(hid_t plist_id)
+      : IdComponent(LibraryLock::call(H5Pcopy, plist_id)) {}
 
   virtual ~PropList() { destruct(); }
 
+  /// Copy and move semantics are those of IdComponent.
+  PropList(const PropList &) = default;
+  PropList &operator=(const PropList &) = default;
+  PropList(PropList &&) = default;
+  PropList &operator=(PropList &&) = default;
+
   /// Close property list.
   void close() override {
+    LibraryLock lock;
     if (!is_valid(get_id())) return;
     if (H5Pclose(get_id()) < 0) throw Exception("PropList::close");
     invalidate();
@@ -49,12 +60,322 @@ class FileAcc : public PropList {
     H5Pset_fapl_mpio(get_id(), comm, info);
     return *this;
   }
+
+  /// Set MPI IO parameters with hints from an MPIInfo object.
+  /// The hints are copied, so the MPIInfo may be destroyed afterwards.
+  FileAcc &set_mpio(MPI_Comm comm, const MPIInfo &info) {
+    return set_mpio(comm, info.get());
+  }
+
+#if H5_VERSION_GE(1, 10, 0)
+  /// Make all metadata reads collective.
+  ///
+  /// Instead of every process reading the same metadata from the file, a
+  /// single process reads it and broadcasts it to the others. All metadata
+  /// read operations (e.g. opening objects) must then be collective.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_ALL_COLL_METADATA_OPS>.
+  FileAcc &set_all_coll_metadata_ops(bool is_collective = true) {
+    if (H5Pset_all_coll_metadata_ops(get_id(), is_collective) < 0)
+      throw Exception("FileAcc::set_all_coll_metadata_ops");
+    return *this;
+  }
+
+  /// Write metadata to the file collectively when flushing the metadata cache.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_COLL_METADATA_WRITE>.
+  FileAcc &set_coll_metadata_write(bool is_collective = true) {
+    if (H5Pset_coll_metadata_write(get_id(), is_collective) < 0)
+      throw Exception("FileAcc::set_coll_metadata_write");
+    return *this;
+  }
+#endif  // H5_VERSION_GE(1, 10, 0)
 #endif  // H5_HAVE_PARALLEL
 
+  /// Align file objects larger than `threshold` bytes on multiples of
+  /// `alignment` bytes.
+  ///
+  /// Aligning datasets on file system block (or stripe) boundaries avoids
+  /// accesses that straddle two blocks.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_ALIGNMENT>.
+  FileAcc &set_alignment(hsize_t threshold, hsize_t alignment) {
+    if (H5Pset_alignment(get_id(), threshold, alignment) < 0)
+      throw Exception("FileAcc::set_alignment");
+    return *this;
+  }
+
+  /// Set minimum size in bytes of metadata block allocations.
+  ///
+  /// Larger blocks aggregate small metadata objects, reducing the number of
+  /// small I/O operations (default: 2048 bytes).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_META_BLOCK_SIZE>.
+  FileAcc &set_meta_block_size(hsize_t size) {
+    if (H5Pset_meta_block_size(get_id(), size) < 0)
+      throw Exception("FileAcc::set_meta_block_size");
+    return *this;
+  }
+
+  /// Set raw data chunk cache parameters for all datasets in the file.
+  ///
+  /// `nslots` is the number of hash table slots (ideally a prime number, about
+  /// 100 times the number of chunks that fit in the cache), `nbytes` is the
+  /// total size of the cache in bytes, and `w0` (between 0 and 1) is the
+  /// preemption policy for fully read or written chunks.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_CACHE>.
+  FileAcc &set_cache(size_t nslots, size_t nbytes, double w0 = 0.75) {
+    // The number of metadata cache elements is ignored since HDF5 1.8.
+    if (H5Pset_cache(get_id(), 0, nslots, nbytes, w0) < 0)
+      throw Exception("FileAcc::set_cache");
+    return *this;
+  }
+
+  /// Use the core (in-memory) file driver.
+  ///
+  /// The whole file is held in memory, which grows by `increment` bytes at a
+  /// time. If `backing_store` is true, the file is written to disk when it is
+  /// closed (or flushed). Otherwise, nothing is written to the file system.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_FAPL_CORE>.
+  FileAcc &set_fapl_core(size_t increment = 1 << 20,
+                         bool backing_store = false) {
+    if (H5Pset_fapl_core(get_id(), increment, backing_store) < 0)
+      throw Exception("FileAcc::set_fapl_core");
+    return *this;
+  }
+
+#if H5_VERSION_GE(1, 8, 13)
+  /// With the core driver and a backing store, only write back the pages of
+  /// `page_size` bytes that were modified (by default, the whole file is
+  /// written).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_CORE_WRITE_TRACKING>.
+  FileAcc &set_core_write_tracking(bool is_enabled, size_t page_size) {
+    if (H5Pset_core_write_tracking(get_id(), is_enabled, page_size) < 0)
+      throw Exception("FileAcc::set_core_write_tracking");
+    return *this;
+  }
+#endif
+
+  /// Set initial contents of a file opened with the core driver.
+  ///
+  /// The buffer is copied, so it can be released afterwards (see also
+  /// File::from_image).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_FILE_IMAGE>.
+  FileAcc &set_file_image(const void *buf, size_t size) {
+    if (H5Pset_file_image(get_id(), const_cast<void *>(buf), size) < 0)
+      throw Exception("FileAcc::set_file_image");
+    return *this;
+  }
+
+  /// Use the family driver, which splits the file into members of
+  /// `member_size` bytes.
+  ///
+  /// The file name must contain a printf-style integer format giving the
+  /// name of each member (e.g. "data-%05d.h5"). Members are accessed with
+  /// `member_fapl`.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_FAPL_FAMILY>.
+  FileAcc &set_fapl_family(hsize_t member_size,
+                           const FileAcc &member_fapl = DEFAULT()) {
+    if (H5Pset_fapl_family(get_id(), member_size, member_fapl.get_id()) < 0)
+      throw Exception("FileAcc::set_fapl_family");
+    return *this;
+  }
+
+  /// Use the split driver, which stores metadata and raw data in two files.
+  ///
+  /// The name of each file is obtained by appending an extension to the
+  /// file name. If an extension contains "%s", it is instead a format in
+  /// which "%s" is replaced by the file name, so that the files can be put in
+  /// different directories (e.g. "/fast/storage/%s.meta" and
+  /// "/bulk/storage/%s.raw", with a relative file name). Each file is
+  /// accessed with its own access property list.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_FAPL_SPLIT>.
+  FileAcc &set_fapl_split(const char *meta_ext = "-m.h5",
+                          const FileAcc &meta_fapl = DEFAULT(),
+                          const char *raw_ext = "-r.h5",
+                          const FileAcc &raw_fapl = DEFAULT()) {
+    if (H5Pset_fapl_split(get_id(), meta_ext, meta_fapl.get_id(), raw_ext,
+                          raw_fapl.get_id()) < 0)
+      throw Exception("FileAcc::set_fapl_split");
+    return *this;
+  }
+
+  FileAcc &set_fapl_split(const std::string &meta_ext,
+                          const FileAcc &meta_fapl,
+                          const std::string &raw_ext,
+                          const FileAcc &raw_fapl = DEFAULT()) {
+    return set_fapl_split(meta_ext.c_str(), meta_fapl, raw_ext.c_str(),
+                          raw_fapl);
+  }
+
+#if H5_VERSION_GE(1, 10, 1)
+  /// Set size in bytes of the page buffer.
+  ///
+  /// The page buffer caches whole file space pages, so that many small
+  /// metadata and raw data accesses become a few page-sized I/O operations.
+  /// It requires a file created with the paged file space strategy (see
+  /// FileCreat::set_file_space_strategy), and `size` must be a multiple of
+  /// the page size. `min_meta_perc` and `min_raw_perc` are the minimum
+  /// percentages of the buffer reserved for metadata and raw data pages.
+  /// Page buffering is not supported by parallel HDF5.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_PAGE_BUFFER_SIZE>.
+  FileAcc &set_page_buffer_size(size_t size, unsigned min_meta_perc = 0,
+                                unsigned min_raw_perc = 0) {
+    if (H5Pset_page_buffer_size(get_id(), size, min_meta_perc,
+                                min_raw_perc) < 0)
+      throw Exception("FileAcc::set_page_buffer_size");
+    return *this;
+  }
+#endif  // H5_VERSION_GE(1, 10, 1)
+
+  /// Get identifier of the file driver (e.g. `H5FD_CORE` or `H5FD_MPIO`).
+  hid_t get_driver() const {
+    hid_t driver = H5Pget_driver(get_id());
+    if (driver < 0) throw Exception("FileAcc::get_driver");
+    return driver;
+  }
+
  protected:
   FileAcc(hid_t plist_id) : PropList(plist_id) {}
 };
 
+/// File creation property list.
+class FileCreat : public PropList {
+ public:
+  /// Copy existing property list using its id.
+  FileCreat(hid_t plist_id) : PropList(plist_id) {}
+
+  /// Create empty property list.
+  FileCreat() : PropList(H5P_FILE_CREATE_DEFAULT) {}
+
+  /// Default property list (`H5P_FILE_CREATE_DEFAULT`).
+  static const FileCreat &DEFAULT() {
+    static FileCreat plist(H5P_FILE_CREATE_DEFAULT);
+    return plist;
+  }
+
+#if H5_VERSION_GE(1, 10, 1)
+  /// Set file space handling strategy.
+  ///
+  /// With `H5F_FSPACE_STRATEGY_PAGE`, small metadata and raw data
+  /// allocations are aggregated into pages (see set_file_space_page_size),
+  /// which can then be cached by the page buffer (see
+  /// FileAcc::set_page_buffer_size). If `persist` is true, free space is
+  /// tracked across file closings. Free sections smaller than `threshold`
+  /// bytes are not tracked.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_FILE_SPACE_STRATEGY>.
+  FileCreat &set_file_space_strategy(H5F_fspace_strategy_t strategy,
+                                     bool persist = false,
+                                     hsize_t threshold = 1) {
+    if (H5Pset_file_space_strategy(get_id(), strategy, persist, threshold) < 0)
+      throw Exception("FileCreat::set_file_space_strategy");
+    return *this;
+  }
+
+  /// Set size in bytes of file space pages (default: 4096 bytes).
+  ///
+  /// Only used with the paged file space strategy. Setting it to the file
+  /// system block size (e.g. the Lustre stripe size) aligns pages to blocks.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_FILE_SPACE_PAGE_SIZE>.
+  FileCreat &set_file_space_page_size(hsize_t size) {
+    if (H5Pset_file_space_page_size(get_id(), size) < 0)
+      throw Exception("FileCreat::set_file_space_page_size");
+    return *this;
+  }
+
+  /// Get file space handling strategy.
+  H5F_fspace_strategy_t get_file_space_strategy() const {
+    H5F_fspace_strategy_t strategy;
+    hbool_t persist;
+    hsize_t threshold;
+    if (H5Pget_file_space_strategy(get_id(), &strategy, &persist,
+                                   &threshold) < 0)
+      throw Exception("FileCreat::get_file_space_strategy");
+    return strategy;
+  }
+
+  /// Get size of file space pages.
+  hsize_t get_file_space_page_size() const {
+    hsize_t size;
+    if (H5Pget_file_space_page_size(get_id(), &size) < 0)
+      throw Exception("FileCreat::get_file_space_page_size");
+    return size;
+  }
+#endif  // H5_VERSION_GE(1, 10, 1)
+};
+
+/// Dataset access property list.
+class DSetAcc : public PropList {
+ public:
+  /// Copy existing property list using its id.
+  DSetAcc(hid_t plist_id) : PropList(plist_id) {}
+
+  /// Create empty property list.
+  DSetAcc() : PropList(H5P_DATASET_ACCESS_DEFAULT) {}
+
+  /// Default property list (`H5P_DATASET_ACCESS_DEFAULT`).
+  static const DSetAcc &DEFAULT() {
+    static DSetAcc plist;
+    return plist;
+  }
+
+  /// Set raw data chunk cache parameters for a single dataset.
+  ///
+  /// Parameters have the same meaning as in FileAcc::set_cache. Passing
+  /// `H5D_CHUNK_CACHE_NSLOTS_DEFAULT`, `H5D_CHUNK_CACHE_NBYTES_DEFAULT` or
+  /// `H5D_CHUNK_CACHE_W0_DEFAULT` keeps the value set on the file access
+  /// property list.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_CHUNK_CACHE>.
+  DSetAcc &set_chunk_cache(size_t nslots, size_t nbytes,
+                           double w0 = H5D_CHUNK_CACHE_W0_DEFAULT) {
+    if (H5Pset_chunk_cache(get_id(), nslots, nbytes, w0) < 0)
+      throw Exception("DSetAcc::set_chunk_cache");
+    return *this;
+  }
+};
+
+/// Link creation property list.
+class LinkCreat : public PropList {
+ public:
+  /// Copy existing property list using its id.
+  LinkCreat(hid_t plist_id) : PropList(plist_id) {}
+
+  /// Create empty property list.
+  LinkCreat() : PropList(H5P_LINK_CREATE_DEFAULT) {}
+
+  /// Default property list (`H5P_DEFAULT`).
+  static const LinkCreat &DEFAULT() {
+    static LinkCreat plist(H5P_DEFAULT);
+    return plist;
+  }
+
+  /// Property list for creating missing intermediate groups (see
+  /// set_create_intermediate_group).
+  static const LinkCreat &CREATE_PARENTS() {
+    static LinkCreat plist = LinkCreat().set_create_intermediate_group(true);
+    return plist;
+  }
+
+  /// Create missing intermediate groups when creating an object.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_CREATE_INTERMEDIATE_GROUP>.
+  LinkCreat &set_create_intermediate_group(bool create = true) {
+    if (H5Pset_create_intermediate_group(get_id(), create) < 0)
+      throw Exception("LinkCreat::set_create_intermediate_group");
+    return *this;
+  }
+};
+
 /// Dataset transfer property list.
 class DSetXfer : public PropList {
  public:
@@ -84,6 +405,44 @@ class DSetXfer : public PropList {
     return set_mpio(H5FD_MPIO_INDEPENDENT);
   }
 
+  /// Set how chunked datasets are transferred in collective mode.
+  ///
+  /// Valid options are `H5FD_MPIO_CHUNK_DEFAULT` (let HDF5 decide),
+  /// `H5FD_MPIO_CHUNK_ONE_IO` (all chunks in a single collective operation)
+  /// and `H5FD_MPIO_CHUNK_MULTI_IO` (one operation per chunk).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_DXPL_MPIO_CHUNK_OPT>.
+  DSetXfer &set_mpio_chunk_opt(H5FD_mpio_chunk_opt_t opt) {
+    if (H5Pset_dxpl_mpio_chunk_opt(get_id(), opt) < 0)
+      throw Exception("DSetXfer::set_mpio_chunk_opt");
+    return *this;
+  }
+
+  /// Set the threshold of average number of chunks per process above which
+  /// HDF5 uses a single collective operation (with `H5FD_MPIO_CHUNK_DEFAULT`).
+  DSetXfer &set_mpio_chunk_opt_num(unsigned num_chunk_per_proc) {
+    if (H5Pset_dxpl_mpio_chunk_opt_num(get_id(), num_chunk_per_proc) < 0)
+      throw Exception("DSetXfer::set_mpio_chunk_opt_num");
+    return *this;
+  }
+
+  /// Set the threshold of percentage of processes per chunk above which
+  /// chunks are written collectively (with `H5FD_MPIO_CHUNK_MULTI_IO`).
+  DSetXfer &set_mpio_chunk_opt_ratio(unsigned percent_proc_per_chunk) {
+    if (H5Pset_dxpl_mpio_chunk_opt_ratio(get_id(), percent_proc_per_chunk) < 0)
+      throw Exception("DSetXfer::set_mpio_chunk_opt_ratio");
+    return *this;
+  }
+
+  /// Set whether collective transfers are done with collective
+  /// (`H5FD_MPIO_COLLECTIVE_IO`, default) or independent
+  /// (`H5FD_MPIO_INDIVIDUAL_IO`) MPI-IO calls.
+  DSetXfer &set_mpio_collective_opt(H5FD_mpio_collective_opt_t opt) {
+    if (H5Pset_dxpl_mpio_collective_opt(get_id(), opt) < 0)
+      throw Exception("DSetXfer::set_mpio_collective_opt");
+    return *this;
+  }
+
   /// Checks the actual IO mode used in a dataset write operation.
   ///
   /// Possible return values are:
@@ -102,6 +461,30 @@ class DSetXfer : public PropList {
       throw Exception("DSetXferPropList::H5D_mpio_actual_io_mode_t");
     return mode;
   }
+
+  /// Checks the actual chunk optimisation scheme used in the last collective
+  /// operation (`H5D_MPIO_NO_CHUNK_OPTIMIZATION`, `H5D_MPIO_LINK_CHUNK` or
+  /// `H5D_MPIO_MULTI_CHUNK`).
+  H5D_mpio_actual_chunk_opt_mode_t get_mpio_actual_chunk_opt_mode() const {
+    H5D_mpio_actual_chunk_opt_mode_t mode;
+    if (H5Pget_mpio_actual_chunk_opt_mode(get_id(), &mode) < 0)
+      throw Exception("DSetXfer::get_mpio_actual_chunk_opt_mode");
+    return mode;
+  }
+
+  /// Get the reasons why collective I/O was not performed in the last
+  /// operation, as bit fields of `H5D_mpio_no_collective_cause_t` values.
+  ///
+  /// `local_cause` contains the causes on the local process, and
+  /// `global_cause` the causes on all processes.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_GET_MPIO_NO_COLLECTIVE_CAUSE>.
+  void get_mpio_no_collective_cause(uint32_t &local_cause,
+                                    uint32_t &global_cause) const {
+    if (H5Pget_mpio_no_collective_cause(get_id(), &local_cause,
+                                        &global_cause) < 0)
+      throw Exception("DSetXfer::get_mpio_no_collective_cause");
+  }
 #endif
 
 };
@@ -136,6 +519,109 @@ class DSetCreat : public PropList {
     return set_chunk(dims.size(), dims.data());
   }
 
+  /// Get chunk size.
+  /// Returns an empty vector if the layout is not chunked.
+  dims_t get_chunk() const {
+    if (get_layout() != H5D_CHUNKED) return dims_t();
+    hsize_t dims[H5S_MAX_RANK];
+    int ndims = LibraryLock::call(H5Pget_chunk, get_id(), H5S_MAX_RANK, dims);
+    if (ndims < 0) throw Exception("DSetCreat::get_chunk");
+    return dims_t(dims, dims + ndims);
+  }
+
+  /// Access pattern used to choose chunk dimensions (see auto_chunk).
+  class AccessHint {
+   public:
+    enum Pattern {
+      /// Reads and writes of arbitrary blocks.
+      BALANCED,
+      /// Reads of whole planes with a fixed index along one axis.
+      PLANES,
+      /// Appending along the first axis (see DataSet::append).
+      APPEND
+    };
+
+    static AccessHint balanced() { return AccessHint(BALANCED, 0); }
+
+    /// Whole-plane reads along `axis` (that is, planes `x[..., i, ...]` with
+    /// a fixed index `i` along `axis`).
+    static AccessHint planes(int axis) { return AccessHint(PLANES, axis); }
+
+    /// Appending along the first axis, which is assumed to be extendable.
+    static AccessHint append() { return AccessHint(APPEND, 0); }
+
+    /// Set size in bytes of the chunk cache of the dataset (see
+    /// DSetAcc::set_chunk_cache). Chunks are not larger than the cache.
+    AccessHint &set_cache_size(size_t nbytes) {
+      _cache_size = nbytes;
+      return *this;
+    }
+
+    /// Set number of MPI processes along each dimension.
+    ///
+    /// The dataset is assumed to be decomposed into equal blocks of
+    /// `ceil(dims[d] / nprocs[d])` elements along each dimension, and chunk
+    /// dimensions are chosen so that chunks don't cross block boundaries.
+    AccessHint &set_decomposition(const dims_t &nprocs) {
+      _decomposition = nprocs;
+      return *this;
+    }
+
+    Pattern pattern() const { return _pattern; }
+    int axis() const { return _axis; }
+
+    /// Chunk cache size (zero if not set).
+    size_t cache_size() const { return _cache_size; }
+
+    /// Number of processes along each dimension (empty if not set).
+    const dims_t &decomposition() const { return _decomposition; }
+
+   private:
+    AccessHint(Pattern pattern, int axis) : _pattern(pattern), _axis(axis) {}
+
+    Pattern _pattern;
+    int _axis;
+    size_t _cache_size = 0;
+    dims_t _decomposition;
+  };
+
+  /// Maximum size of chunks chosen by auto_chunk, in bytes.
+  static size_t max_auto_chunk_bytes() { return 1 << 20; }
+
+  /// Choose chunk dimensions for a dataset (see auto_chunk).
+  ///
+  /// Chunks are as large as possible within the smaller of the chunk cache
+  /// size (by default, 1 MiB) and max_auto_chunk_bytes(). Starting from the
+  /// full dataset (or the block of a single process, if a decomposition is
+  /// given), chunk dimensions are halved until the chunk fits, largest
+  /// dimension first. Additionally:
+  ///
+  /// - for PLANES, the chunk has a single element along the plane axis, so
+  ///   that reading a plane doesn't read any other data;
+  /// - for APPEND, chunks span as much of a record (the data appended at
+  ///   a single index along the first axis) as possible, and then as many
+  ///   records as fit (the decomposition along the first axis is ignored).
+  ///
+  /// Zero dimensions (for instance, extendable dimensions that are initially
+  /// empty) don't limit the chunk size.
+  ///
+  /// If the maximum dimensions of the dataspace are given, chunks don't
+  /// exceed the maximum size of fixed-size (not `H5S_UNLIMITED`) dimensions,
+  /// as required by HDF5. In particular, for APPEND with a fixed-size first
+  /// dimension, chunks span at most the whole dataset along that dimension.
+  /// Otherwise, the first dimension is assumed to be extendable for APPEND.
+  static dims_t guess_chunk(const dims_t &dims, size_t elem_size,
+                            const AccessHint &hint = AccessHint::balanced(),
+                            const dims_t &maxdims = dims_t());
+
+  /// Set chunk dimensions chosen for the given dataset dimensions, element
+  /// size and access pattern (see guess_chunk).
+  DSetCreat &auto_chunk(const dims_t &dims, size_t elem_size,
+                        const AccessHint &hint = AccessHint::balanced(),
+                        const dims_t &maxdims = dims_t()) {
+    return set_chunk(guess_chunk(dims, elem_size, hint, maxdims));
+  }
+
   /// Set shuffle filter.
   DSetCreat &set_shuffle() {
     H5Pset_shuffle(get_id());
@@ -149,6 +635,157 @@ class DSetCreat : public PropList {
     return *this;
   }
 
+  /// Identifiers of filters registered with The HDF Group, which are provided
+  /// as plugins (see <https://github.com/HDFGroup/hdf5_plugins>).
+  ///
+  /// The setters for these filters (set_blosc2, set_zstd, set_lz4 and
+  /// set_bitshuffle) throw an exception if the plugin can't be loaded. The
+  /// filters are set as optional, so that chunks that can't be compressed are
+  /// stored unfiltered.
+  enum RegisteredFilter : H5Z_filter_t {
+    FILTER_BLOSC = 32001,
+    FILTER_LZ4 = 32004,
+    FILTER_BITSHUFFLE = 32008,
+    FILTER_ZSTD = 32015,
+    FILTER_BLOSC2 = 32026,
+  };
+
+  /// Returns true if a filter is available for encoding (that is, it is
+  /// either built into the library or can be loaded as a plugin).
+  static bool filter_available(H5Z_filter_t id) {
+    htri_t avail;
+    H5E_BEGIN_TRY { avail = H5Zfilter_avail(id); }
+    H5E_END_TRY;
+    if (avail <= 0) return false;
+    unsigned config = 0;
+    if (H5Zget_filter_info(id, &config) < 0) return false;
+    return config & H5Z_FILTER_CONFIG_ENCODE_ENABLED;
+  }
+
+  /// Add filter to the pipeline.
+  ///
+  /// `flags` is either `H5Z_FLAG_MANDATORY` or `H5Z_FLAG_OPTIONAL`, and
+  /// `cd_values` are the filter parameters. Unless the filter is optional, an
+  /// exception is thrown if the filter is not available (see
+  /// filter_available).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_FILTER>.
+  DSetCreat &set_filter(H5Z_filter_t id, unsigned flags = H5Z_FLAG_MANDATORY,
+                        const std::vector<unsigned> &cd_values = {}) {
+    return _set_filter(id, std::to_string(id), flags, cd_values);
+  }
+
+  /// Compressors used by the Blosc2 filter.
+  enum BloscCompressor {
+    BLOSC_BLOSCLZ = 0,
+    BLOSC_LZ4 = 1,
+    BLOSC_LZ4HC = 2,
+    BLOSC_ZLIB = 4,
+    BLOSC_ZSTD = 5,
+  };
+
+  /// Shuffle modes of the Blosc2 filter.
+  enum BloscShuffle {
+    BLOSC_NOSHUFFLE = 0,
+    BLOSC_SHUFFLE = 1,
+    BLOSC_BITSHUFFLE = 2,
+  };
+
+  /// Set Blosc2 filter (plugin), with compression level between 0 and 9.
+  ///
+  /// Blosc2 splits chunks into blocks that are shuffled and compressed
+  /// independently, and is typically much faster than deflate.
+  DSetCreat &set_blosc2(unsigned level = 5,
+                        BloscCompressor compressor = BLOSC_LZ4,
+                        BloscShuffle shuffle = BLOSC_SHUFFLE) {
+    // The first four values are set by the filter.
+    _check_filter(FILTER_BLOSC2, "Blosc2");
+    return _set_filter(FILTER_BLOSC2, "Blosc2", H5Z_FLAG_OPTIONAL,
+                       {0, 0, 0, 0, level, unsigned(shuffle),
+                        unsigned(compressor)});
+  }
+
+  /// Set Zstandard filter (plugin), with compression level between 1 and 22.
+  DSetCreat &set_zstd(unsigned level = 3) {
+    _check_filter(FILTER_ZSTD, "Zstandard");
+    return _set_filter(FILTER_ZSTD, "Zstandard", H5Z_FLAG_OPTIONAL, {level});
+  }
+
+  /// Set LZ4 filter (plugin).
+  ///
+  /// Chunks are compressed in blocks of `block_size` bytes (if zero, the
+  /// filter default of 1 GiB is used).
+  DSetCreat &set_lz4(unsigned block_size = 0) {
+    _check_filter(FILTER_LZ4, "LZ4");
+    return _set_filter(FILTER_LZ4, "LZ4", H5Z_FLAG_OPTIONAL, {block_size});
+  }
+
+  /// Compression applied after the bitshuffle filter.
+  enum BitshuffleCompression {
+    BITSHUFFLE_NONE = 0,
+    BITSHUFFLE_LZ4 = 2,
+    BITSHUFFLE_ZSTD = 3,
+  };
+
+  /// Set bitshuffle filter (plugin), optionally followed by LZ4 or Zstandard
+  /// compression.
+  ///
+  /// If `block_size` (in elements) is zero, the filter chooses it. The
+  /// compression level is only used with Zstandard.
+  DSetCreat &set_bitshuffle(
+      BitshuffleCompression compression = BITSHUFFLE_LZ4,
+      unsigned block_size = 0, unsigned zstd_level = 3) {
+    _check_filter(FILTER_BITSHUFFLE, "bitshuffle");
+    // The first three values are set by the filter.
+    std::vector<unsigned> cd = {0, 0, 0, block_size, unsigned(compression)};
+    if (compression == BITSHUFFLE_ZSTD) cd.push_back(zstd_level);
+    return _set_filter(FILTER_BITSHUFFLE, "bitshuffle", H5Z_FLAG_OPTIONAL, cd);
+  }
+
+  /// Set szip compression filter (built into HDF5 if it was built with szip
+  /// or libaec).
+  ///
+  /// `options_mask` is `H5_SZIP_NN_OPTION_MASK` (nearest neighbour coding,
+  /// suited to smooth data) or `H5_SZIP_EC_OPTION_MASK` (entropy coding), and
+  /// `pixels_per_block` is an even number, at most 32.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_SZIP>.
+  DSetCreat &set_szip(unsigned options_mask = H5_SZIP_NN_OPTION_MASK,
+                      unsigned pixels_per_block = 16) {
+    _check_filter(H5Z_FILTER_SZIP, "szip");
+    if (H5Pset_szip(get_id(), options_mask, pixels_per_block) < 0)
+      throw Exception("DSetCreat::set_szip");
+    return *this;
+  }
+
+  /// Set scale-offset filter.
+  ///
+  /// For integer data (`H5Z_SO_INT`), `scale_factor` is the minimum number of
+  /// bits to keep (`H5Z_SO_INT_MINBITS_DEFAULT` lets the filter compute it),
+  /// and compression is lossless. For floating point data
+  /// (`H5Z_SO_FLOAT_DSCALE`), values are rounded to `scale_factor` decimal
+  /// digits, so compression is lossy.
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_SCALEOFFSET>.
+  DSetCreat &set_scaleoffset(H5Z_SO_scale_type_t scale_type, int scale_factor) {
+    _check_filter(H5Z_FILTER_SCALEOFFSET, "scale-offset");
+    if (H5Pset_scaleoffset(get_id(), scale_type, scale_factor) < 0)
+      throw Exception("DSetCreat::set_scaleoffset");
+    return *this;
+  }
+
+  /// Set N-bit filter.
+  ///
+  /// Only the significant bits of each value are stored, as given by the
+  /// precision and offset of the dataset datatype (see `H5Tset_precision`).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5P_SET_NBIT>.
+  DSetCreat &set_nbit() {
+    _check_filter(H5Z_FILTER_NBIT, "N-bit");
+    if (H5Pset_nbit(get_id()) < 0) throw Exception("DSetCreat::set_nbit");
+    return *this;
+  }
+
   /// Set storage type.
   /// Possible values are `H5D_COMPACT`, `H5D_CONTIGUOUS`, `H5D_CHUNKED` and
   /// `H5D_VIRTUAL`.
@@ -162,11 +799,126 @@ class DSetCreat : public PropList {
   /// Possible return values are `H5D_COMPACT`, `H5D_CONTIGUOUS`, `H5D_CHUNKED`
   /// and `H5D_VIRTUAL`.
   H5D_layout_t get_layout() const {
-    auto layout = H5Pget_layout(get_id());
+    auto layout = LibraryLock::call(H5Pget_layout, get_id());
     if (layout < 0) throw Exception("DSetCreat::get_layout");
     return layout;
   }
+
+ private:
+  /// Throw exception if a filter is not available.
+  static void _check_filter(H5Z_filter_t id, const std::string &name) {
+    if (filter_available(id)) return;
+    throw Exception(
+        "DSetCreat::set_filter",
+        "The " + name + " filter (id " + std::to_string(id) +
+            ") is not available for encoding. If it is provided as a plugin, "
+            "check that HDF5_PLUGIN_PATH contains the plugin library.");
+  }
+
+  DSetCreat &_set_filter(H5Z_filter_t id, const std::string &name,
+                         unsigned flags, const std::vector<unsigned> &cd) {
+    if (!(flags & H5Z_FLAG_OPTIONAL)) _check_filter(id, name);
+    if (H5Pset_filter(get_id(), id, flags, cd.size(), cd.data()) < 0)
+      throw Exception("DSetCreat::set_filter",
+                      "Error setting the " + name + " filter.");
+    return *this;
+  }
 };
 
 }  // namespace PropList
 }  // namespace HDF5
+
+// Function implementation.
+namespace HDF5 {
+namespace PropList {
+
+inline dims_t DSetCreat::guess_chunk(const dims_t &dims, size_t elem_size,
+                                     const AccessHint &hint,
+                                     const dims_t &maxdims) {
+  const size_t rank = dims.size();
+  auto &nprocs = hint.decomposition();
+  if (rank == 0 || elem_size == 0)
+    throw Exception("DSetCreat::guess_chunk", "Invalid dimensions.");
+  if (!nprocs.empty() && nprocs.size() != rank)
+    throw Exception("DSetCreat::guess_chunk",
+                    "Decomposition must have the same rank as the dataset.");
+  if (!maxdims.empty() && maxdims.size() != rank)
+    throw Exception(
+        "DSetCreat::guess_chunk",
+        "Maximum dimensions must have the same rank as the dataset.");
+  auto is_fixed = [&maxdims](size_t d) {
+    return !maxdims.empty() && maxdims[d] != H5S_UNLIMITED;
+  };
+  if (hint.pattern() == AccessHint::PLANES &&
+      (hint.axis() < 0 || size_t(hint.axis()) >= rank))
+    throw Exception("DSetCreat::guess_chunk", "Invalid plane axis.");
+
+  // The default chunk cache size of HDF5 is 1 MiB.
+  const size_t cache = hint.cache_size() ? hint.cache_size() : 1 << 20;
+  const hsize_t target =
+      std::max<size_t>(1, std::min(cache, max_auto_chunk_bytes()) / elem_size);
+
+  // Largest possible chunk along each dimension: the block of a process, or
+  // the whole dimension.
+  dims_t limit(rank);
+  for (size_t d = 0; d < rank; ++d) {
+    hsize_t n = dims[d] ? dims[d] : target;
+    if (is_fixed(d)) n = std::min(n, maxdims[d]);
+    if (!nprocs.empty() && nprocs[d] > 1) n = (n + nprocs[d] - 1) / nprocs[d];
+    limit[d] = std::max<hsize_t>(n, 1);
+  }
+
+  // Shrink chunk along dimension d. With a decomposition, chunk dimensions
+  // remain divisors of the process blocks.
+  auto shrink = [&](dims_t &chunk, size_t d) {
+    hsize_t n = (chunk[d] + 1) / 2;
+    if (!nprocs.empty())
+      while (limit[d] % n) --n;
+    chunk[d] = n;
+  };
+
+  auto length = [](const dims_t &chunk, size_t skip) {
+    hsize_t N = 1;
+    for (size_t d = 0; d < chunk.size(); ++d)
+      if (d != skip) N *= chunk[d];
+    return N;
+  };
+
+  // Shrink largest dimensions (except `fixed`) until the chunk fits in
+  // `target` elements.
+  auto fit = [&](dims_t &chunk, size_t fixed) {
+    while (length(chunk, rank) > target) {
+      size_t dmax = rank;
+      for (size_t d = 0; d < rank; ++d)
+        if (d != fixed && chunk[d] > 1 &&
+            (dmax == rank || chunk[d] > chunk[dmax]))
+          dmax = d;
+      if (dmax == rank) break;
+      shrink(chunk, dmax);
+    }
+  };
+
+  dims_t chunk = limit;
+  switch (hint.pattern()) {
+    case AccessHint::PLANES:
+      chunk[hint.axis()] = 1;
+      fit(chunk, hint.axis());
+      break;
+    case AccessHint::APPEND: {
+      // Fit a single record, then as many records as possible. If the first
+      // dimension is extendable, it is not limited by its current size.
+      chunk[0] = 1;
+      fit(chunk, 0);
+      chunk[0] = std::max<hsize_t>(1, target / length(chunk, 0));
+      if (is_fixed(0) && maxdims[0] > 0)
+        chunk[0] = std::min(chunk[0], maxdims[0]);
+      break;
+    }
+    default:
+      fit(chunk, rank);
+  }
+  return chunk;
+}
+
+}  // namespace PropList
+}  // namespace HDF5
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "DataSet.h"
+#include "LibraryLock.h"
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+namespace HDF5 {
+
+/// Sweeps an N-dimensional dataset one block at a time, prefetching the next
+/// block on a background thread.
+///
+/// Blocks are visited in row-major order of the block grid. By default, blocks
+/// have the chunk dimensions of the dataset (or, for non-chunked datasets,
+/// they are single slabs along the first dimension), so that blocks are
+/// aligned to the storage of the dataset. Blocks at the upper boundaries of
+/// the dataset may be smaller.
+///
+/// While the caller processes block k, block k + 1 is read into a second
+/// buffer. Prefetching requires sharing the dataset with a background thread
+/// (see LibraryLock::thread_safe). If this is not possible, blocks are read
+/// synchronously by next().
+///
+/// Example:
+///
+///     SlabIterator<float, 4> it(dset);
+///     while (it.next()) {
+///       auto &start = it.start();   // position of the block in the dataset
+///       auto &count = it.count();   // block dimensions
+///       process(it.data(), start, count);
+///     }
+///
+template <typename T, size_t N>
+class SlabIterator {
+ public:
+  /// Create iterator over a dataset of rank N.
+  ///
+  /// If `block` is not given (or contains zeros), blocks take the dataset
+  /// chunk dimensions. If `prefetch` is false, blocks are read synchronously.
+  explicit SlabIterator(const DataSet &dset, const adims_t<N> &block = {},
+                        bool prefetch = true);
+
+  ~SlabIterator() {
+    if (_pending.valid()) _pending.wait();
+  }
+
+  SlabIterator(const SlabIterator &) = delete;
+  SlabIterator &operator=(const SlabIterator &) = delete;
+
+  /// Advance to the next block.
+  /// Returns false if all blocks have been visited.
+  bool next();
+
+  /// Data of the current block in row-major order.
+  const std::vector<T> &data() const { return _buf[_current].data; }
+
+  /// Offset of the current block in the dataset.
+  const adims_t<N> &start() const { return _buf[_current].start; }
+
+  /// Dimensions of the current block.
+  const adims_t<N> &count() const { return _buf[_current].count; }
+
+  /// Index of the current block.
+  size_t index() const { return _next - 1; }
+
+  /// Total number of blocks.
+  size_t num_blocks() const { return _num_blocks; }
+
+  /// Nominal block dimensions.
+  const adims_t<N> &block() const { return _block; }
+
+ private:
+  /// Buffer holding one block, with dataspaces that are reused across blocks.
+  struct Buffer {
+    std::vector<T> data;
+    adims_t<N> start;
+    adims_t<N> count;
+    DataSpace file_space;
+    DataSpace mem_space;
+  };
+
+  DataSet _dset;
+  adims_t<N> _dims;
+  adims_t<N> _block;
+  adims_t<N> _grid;  // number of blocks along each dimension
+  size_t _num_blocks = 1;
+  bool _prefetch;
+
+  Buffer _buf[2];
+  size_t _current = 0;  // buffer of the current block
+  size_t _next = 0;     // index of the next block
+  std::future<void> _pending;
+
+  /// Read block `k` into buffer `k % 2`.
+  void _read(size_t k);
+};
+
+}  // namespace HDF5
+
+// Function implementation.
+namespace HDF5 {
+
+template <typename T, size_t N>
+inline SlabIterator<T, N>::SlabIterator(const DataSet &dset,
+                                        const adims_t<N> &block, bool prefetch)
+    : _dset(dset), _block(block),
+      _prefetch(prefetch && LibraryLock::thread_safe()) {
+  auto space = dset.get_dataspace();
+  if (space.ndims() != int(N))
+    throw Exception("SlabIterator::SlabIterator",
+                    "Dataset rank doesn't match the iterator rank.");
+  const auto extent = space.extent();
+  std::copy(extent.begin(), extent.end(), _dims.begin());
+
+  if (std::count(_block.begin(), _block.end(), 0) > 0) {
+    auto chunk = dset.get_create_plist().get_chunk();
+    for (size_t d = 0; d < N; ++d) {
+      if (_block[d]) continue;
+      if (!chunk.empty())
+        _block[d] = chunk[d];
+      else
+        _block[d] = d == 0 ? 1 : _dims[d];
+    }
+  }
+
+  for (size_t d = 0; d < N; ++d) {
+    _block[d] = std::max<hsize_t>(_block[d], 1);
+    _grid[d] = (_dims[d] + _block[d] - 1) / _block[d];
+    _num_blocks *= _grid[d];
+  }
+
+  for (auto &b : _buf) b.file_space = space.copy();
+}
+
+template <typename T, size_t N>
+inline void SlabIterator<T, N>::_read(size_t k) {
+  Buffer &b = _buf[k % 2];
+  for (size_t d = N; d-- > 0;) {
+    b.start[d] = (k % _grid[d]) * _block[d];
+    k /= _grid[d];
+  }
+  bool same_count = b.data.size() > 0;
+  size_t length = 1;
+  for (size_t d = 0; d < N; ++d) {
+    hsize_t n = std::min(_block[d], _dims[d] - b.start[d]);
+    same_count = same_count && n == b.count[d];
+    b.count[d] = n;
+    length *= n;
+  }
+  // The memory dataspace is only recreated at the boundaries of the dataset.
+  if (!same_count) b.mem_space = DataSpace(b.count);
+  b.data.resize(length);
+  b.file_space.select_hyperslab(H5S_SELECT_SET, b.count.data(),
+                                b.start.data());
+  _dset.read(b.data.data(), b.mem_space, b.file_space);
+}
+
+template <typename T, size_t N>
+inline bool SlabIterator<T, N>::next() {
+  if (_next >= _num_blocks) return false;
+  if (_pending.valid())
+    _pending.get();  // rethrows errors from the background thread
+  else
+    _read(_next);
+  _current = _next % 2;
+  ++_next;
+  if (_prefetch && _next < _num_blocks)
+    _pending =
+        std::async(std::launch::async, &SlabIterator::_read, this, _next);
+  return true;
+}
+
+}  // namespace HDF5
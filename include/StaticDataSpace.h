@@ -0,0 +1,120 @@
+#pragma once
+
+#include "DataSpace.h"
+
+#include <type_traits>
+
+namespace HDF5 {
+
+/// Simple dataspace with compile-time rank.
+///
+/// Dimensions and selections are described by fixed-size arrays (adims_t), so
+/// that shape queries and hyperslab selections don't allocate memory, and rank
+/// mismatches are detected at compile time. A StaticDataSpace can be used
+/// wherever a DataSpace is expected.
+template <size_t N>
+class StaticDataSpace : public DataSpace {
+  static_assert(N >= 1 && N <= H5S_MAX_RANK, "Invalid dataspace rank.");
+
+ public:
+  /// Rank of the dataspace.
+  static constexpr size_t rank = N;
+
+  /// Dimensions of the dataspace.
+  using dims_type = adims_t<N>;
+
+  /// Hyperslab with the same rank as the dataspace.
+  using slab_type = Hyperslab<N>;
+
+  /// Create simple dataspace (e.g. StaticDataSpace<2> space({3, 4})).
+  StaticDataSpace(const dims_type &dims) : DataSpace(dims) {}
+
+  /// Create extendable simple dataspace with maximum dimensions.
+  StaticDataSpace(const dims_type &dims, const dims_type &maxdims)
+      : DataSpace(dims, maxdims) {}
+
+  /// Create from existing DataSpace.
+  /// Throws an exception if its rank is not N.
+  ///
+  /// This is a template to avoid ambiguities with list-initialisation of
+  /// dimensions (since a DataSpace can also be created from a list).
+  template <typename Space, typename = typename std::enable_if<
+                                std::is_base_of<DataSpace, Space>::value>::type>
+  explicit StaticDataSpace(const Space &space) : DataSpace(space) {
+    _check_rank();
+  }
+
+  /// Create from existing dataspace id.
+  /// Throws an exception if its rank is not N.
+  explicit StaticDataSpace(hid_t space_id) : DataSpace(space_id) {
+    _check_rank();
+  }
+
+  /// Returns number of dimensions of the dataspace.
+  static constexpr int ndims() { return N; }
+
+  /// Returns dimensions of the dataspace.
+  dims_type size() const {
+    dims_type dims;
+    const Extent e = extent();
+    for (size_t i = 0; i < N; ++i) dims[i] = e[i];
+    return dims;
+  }
+
+  /// Returns size of the dataspace along a single dimension.
+  hsize_t size(size_t i) const {
+    if (i >= N)
+      throw Exception("StaticDataSpace::size(int)", "Invalid dimension index.");
+    return extent()[i];
+  }
+
+  hsize_t operator[](size_t i) const { return size(i); }
+
+  /// Select hyperslab using Hyperslab object.
+  StaticDataSpace &select_hyperslab(const slab_type &h,
+                                    H5S_seloper_t op = H5S_SELECT_SET) {
+    DataSpace::select_hyperslab(h, op);
+    return *this;
+  }
+
+  /// Select contiguous block of elements.
+  StaticDataSpace &select_block(const dims_type &start, const dims_type &count,
+                                H5S_seloper_t op = H5S_SELECT_SET) {
+    DataSpace::select_hyperslab(op, count.data(), start.data());
+    return *this;
+  }
+
+  /// Offset the current selection by the given number of elements along each
+  /// dimension (without changing the selection itself).
+  ///
+  /// See <https://portal.hdfgroup.org/display/HDF5/H5S_OFFSET_SIMPLE>.
+  StaticDataSpace &offset_simple(const std::array<hssize_t, N> &offset) {
+    if (H5Soffset_simple(get_id(), offset.data()) < 0)
+      throw Exception("StaticDataSpace::offset_simple");
+    return *this;
+  }
+
+  /// Linear (row-major) index of an element with the given coordinates.
+  static hsize_t linear_index(const dims_type &dims, const dims_type &idx) {
+    hsize_t n = idx[0];
+    for (size_t i = 1; i < N; ++i) n = n * dims[i] + idx[i];
+    return n;
+  }
+
+  /// Linear index of an element in this dataspace.
+  hsize_t linear_index(const dims_type &idx) const {
+    return linear_index(size(), idx);
+  }
+
+ private:
+  void _check_rank() const {
+    if (DataSpace::ndims() != int(N))
+      throw Exception("StaticDataSpace::StaticDataSpace",
+                      "Rank of dataspace doesn't match template parameter.");
+  }
+};
+
+template <size_t N>
+constexpr size_t StaticDataSpace<N>::rank;
+
+}  // namespace HDF5
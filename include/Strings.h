@@ -0,0 +1,191 @@
+#pragma once
+
+#include "DataSpace.h"
+#include "DataType.h"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>  // distance
+#include <string>
+#include <vector>
+
+namespace HDF5 {
+
+/// Array of fixed-length strings stored in a single contiguous buffer.
+///
+/// Each string occupies `width()` bytes and is padded with null characters.
+/// This is the in-memory layout of fixed-length (`H5T_STR_NULLPAD`) string
+/// datasets, so that reading and writing don't require any per-string
+/// allocations. See DataSet::write(const FixedStrings &) and
+/// DataSet::read(FixedStrings &).
+class FixedStrings {
+ public:
+  FixedStrings() = default;
+
+  /// Create `n` empty strings of the given width.
+  FixedStrings(size_t width, size_t n) : _width(width), _data(width * n) {}
+
+  /// Pack strings.
+  ///
+  /// If `width` is zero, it is set to the length of the longest string.
+  /// Otherwise, an exception is thrown if a string is longer than `width`.
+  template <typename Alloc>
+  explicit FixedStrings(const std::vector<std::string, Alloc> &strings,
+                        size_t width = 0) {
+    _pack(strings.begin(), strings.end(), width);
+  }
+
+  /// Pack list of strings (e.g. `FixedStrings({"a", "bb"})`).
+  explicit FixedStrings(std::initializer_list<std::string> strings,
+                        size_t width = 0) {
+    _pack(strings.begin(), strings.end(), width);
+  }
+
+  /// Number of strings.
+  size_t size() const { return _width ? _data.size() / _width : 0; }
+
+  /// Maximum length of each string, in bytes.
+  size_t width() const { return _width; }
+
+  /// Change the number of strings (new strings are empty).
+  void resize(size_t n) { _data.resize(_width * n); }
+
+  char *data() { return _data.data(); }
+  const char *data() const { return _data.data(); }
+
+  /// Pointer to string `i` (not necessarily null-terminated).
+  const char *operator[](size_t i) const { return _data.data() + i * _width; }
+
+  /// Length of string `i`.
+  size_t length(size_t i) const {
+    const char *p = (*this)[i];
+    return std::find(p, p + _width, '\0') - p;
+  }
+
+  /// Returns copy of string `i`.
+  std::string str(size_t i) const { return std::string((*this)[i], length(i)); }
+
+  /// Unpack strings into a vector.
+  template <typename Alloc>
+  void to_vector(std::vector<std::string, Alloc> &v) const {
+    v.resize(size());
+    for (size_t i = 0; i < v.size(); ++i) v[i].assign((*this)[i], length(i));
+  }
+
+  /// Fixed-length, null-padded UTF-8 string datatype of the same width.
+  DataType datatype() const {
+    DataType type = H5Tcopy(H5T_C_S1);
+    if (H5Tset_size(type.get_id(), std::max<size_t>(_width, 1)) < 0 ||
+        H5Tset_strpad(type.get_id(), H5T_STR_NULLPAD) < 0 ||
+        H5Tset_cset(type.get_id(), H5T_CSET_UTF8) < 0)
+      throw Exception("FixedStrings::datatype");
+    return type;
+  }
+
+  /// Memory datatype for transferring strings of a fixed-length file
+  /// datatype: same character set, null-padded, with the given width (by
+  /// default, the size of the file datatype).
+  static DataType memory_type(const DataType &file_type, size_t width = 0) {
+    DataType type = H5Tcopy(file_type.get_id());
+    if ((width && H5Tset_size(type.get_id(), width) < 0) ||
+        H5Tset_strpad(type.get_id(), H5T_STR_NULLPAD) < 0)
+      throw Exception("FixedStrings::memory_type");
+    return type;
+  }
+
+ private:
+  size_t _width = 0;
+  std::vector<char> _data;
+
+  template <typename Iterator>
+  void _pack(Iterator first, Iterator last, size_t width) {
+    if (width == 0) {
+      for (auto it = first; it != last; ++it)
+        width = std::max(width, it->size());
+      width = std::max<size_t>(width, 1);
+    }
+    _width = width;
+    _data.resize(width * std::distance(first, last));
+    char *p = _data.data();
+    for (auto it = first; it != last; ++it) {
+      if (it->size() > width)
+        throw Exception("FixedStrings::FixedStrings",
+                        "String is longer than the fixed width.");
+      std::copy(it->begin(), it->end(), p);
+      p += width;
+    }
+  }
+};
+
+/// Buffer of variable-length strings read from HDF5.
+///
+/// The strings are allocated by the HDF5 library when reading, and are
+/// released at destruction with a single call to `H5Treclaim` (or
+/// `H5Dvlen_reclaim` before HDF5 1.12).
+class VLenStrings {
+ public:
+  /// Create buffer for `n` strings of the given (variable-length) datatype.
+  /// The transfer property list must be the one used to read the strings.
+  VLenStrings(size_t n, const DataType &type, hid_t xfer_plist = H5P_DEFAULT)
+      : _ptrs(n, nullptr), _type(type), _xfer(xfer_plist) {}
+
+  ~VLenStrings() { reclaim(); }
+
+  VLenStrings(const VLenStrings &) = delete;
+  VLenStrings &operator=(const VLenStrings &) = delete;
+
+  /// Buffer to be passed to H5Dread or H5Aread.
+  char **data() { return _ptrs.data(); }
+
+  size_t size() const { return _ptrs.size(); }
+
+  /// Pointer to string `i` (may be null).
+  const char *operator[](size_t i) const { return _ptrs[i]; }
+
+  /// Length of string `i`.
+  size_t length(size_t i) const { return _ptrs[i] ? std::strlen(_ptrs[i]) : 0; }
+
+  /// Copy strings into a vector.
+  template <typename Alloc>
+  void to_vector(std::vector<std::string, Alloc> &v) const {
+    v.resize(size());
+    for (size_t i = 0; i < v.size(); ++i) {
+      if (_ptrs[i])
+        v[i].assign(_ptrs[i]);
+      else
+        v[i].clear();
+    }
+  }
+
+  /// Copy strings into a contiguous fixed-width buffer (with the width of the
+  /// longest string).
+  FixedStrings to_fixed() const {
+    size_t width = 1;
+    for (size_t i = 0; i < size(); ++i) width = std::max(width, length(i));
+    FixedStrings s(width, size());
+    for (size_t i = 0; i < size(); ++i)
+      std::copy(_ptrs[i], _ptrs[i] + length(i), s.data() + i * width);
+    return s;
+  }
+
+  /// Release strings allocated by HDF5.
+  void reclaim() noexcept {
+    if (_ptrs.empty()) return;
+    hsize_t n = _ptrs.size();
+    DataSpace space(1, &n);
+#if H5_VERSION_GE(1, 12, 0)
+    H5Treclaim(_type.get_id(), space.get_id(), _xfer, _ptrs.data());
+#else
+    H5Dvlen_reclaim(_type.get_id(), space.get_id(), _xfer, _ptrs.data());
+#endif
+    std::fill(_ptrs.begin(), _ptrs.end(), nullptr);
+  }
+
+ private:
+  std::vector<char *> _ptrs;
+  DataType _type;
+  hid_t _xfer;
+};
+
+}  // namespace HDF5